@@ -0,0 +1,136 @@
+/*
+ * Effect kernels: the pixel_t array (AoS) kernels of dled_pixel against the color plane (SoA)
+ * kernels of dled_pixel_planes, and the buffer fill from both. Both sides run the same sequence
+ * on the same data and are compared after every kernel, the benchmark fails on a difference.
+ */
+
+#include "dled_pixel.h"
+#include "dled_pixel_planes.h"
+#include "dled_strip.h"
+#include "dled_port.h"
+#include "dled_test.h"
+
+#include <stdlib.h>
+
+static const uint16_t leds = 1024;
+static const uint32_t iterations = 2000;
+
+static pixel_t aos[leds], aos_src[leds];
+static pixel_planes_t soa, soa_src;
+
+static bool same(void)
+{
+    for (uint16_t i = 0; i < leds; i++)
+        if (aos[i].r != soa.r[i] || aos[i].g != soa.g[i] || aos[i].b != soa.b[i]) return false;
+    return true;
+}
+
+static void randomize(void)
+{
+    for (uint16_t i = 0; i < leds; i++) {
+        aos[i].r = soa.r[i] = rand();
+        aos[i].g = soa.g[i] = rand();
+        aos[i].b = soa.b[i] = rand();
+        aos_src[i].r = soa_src.r[i] = rand();
+        aos_src[i].g = soa_src.g[i] = rand();
+        aos_src[i].b = soa_src.b[i] = rand();
+    }
+}
+
+typedef enum { FILL, FADE, SCALE_HALF, SCALE, ADD, BLUR } kernel_t;
+static const char *kernel_names[] = { "fill", "fade", "scale 127", "scale 200", "add", "blur" };
+
+static void run_aos(kernel_t kernel)
+{
+    switch (kernel) {
+        case FILL:       dled_pixel_fill(aos, leds, 1, 2, 3); break;
+        case FADE:       dled_pixel_fade(aos, leds, 3); break;
+        case SCALE_HALF: dled_pixel_scale(aos, leds, 127); break;
+        case SCALE:      dled_pixel_scale(aos, leds, 200); break;
+        case ADD:        dled_pixel_add(aos, aos_src, leds); break;
+        case BLUR:       dled_pixel_blur(aos, leds); break;
+    }
+}
+
+static void run_soa(kernel_t kernel)
+{
+    switch (kernel) {
+        case FILL:       dled_planes_fill(&soa, 1, 2, 3); break;
+        case FADE:       dled_planes_fade(&soa, 3); break;
+        case SCALE_HALF: dled_planes_scale(&soa, 127); break;
+        case SCALE:      dled_planes_scale(&soa, 200); break;
+        case ADD:        dled_planes_add(&soa, &soa_src); break;
+        case BLUR:       dled_planes_blur(&soa); break;
+    }
+}
+
+static double ns_per_pixel(int64_t elapsed_us)
+{
+    return (double)elapsed_us * 1000.0 / ((double)iterations * leds);
+}
+
+static void bench_kernel(kernel_t kernel)
+{
+    randomize();
+    run_aos(kernel);
+    run_soa(kernel);
+    TEST_CHECK(same());
+
+    int64_t start = dled_port_time_us();
+    for (uint32_t i = 0; i < iterations; i++) run_aos(kernel);
+    int64_t aos_us = dled_port_time_us() - start;
+
+    start = dled_port_time_us();
+    for (uint32_t i = 0; i < iterations; i++) run_soa(kernel);
+    int64_t soa_us = dled_port_time_us() - start;
+    TEST_CHECK(same());
+
+    printf("  %-12s AoS %6.2f ns/pixel, SoA %6.2f ns/pixel, AoS / SoA %.2f\n", kernel_names[kernel],
+           ns_per_pixel(aos_us), ns_per_pixel(soa_us), (double)aos_us / (soa_us ? soa_us : 1));
+}
+
+static void bench_fill_buffer(void)
+{
+    pixel_strip_t strip_aos, strip_soa;
+    dled_strip_init(&strip_aos);
+    dled_strip_init(&strip_soa);
+    TEST_CHECK(dled_strip_create(&strip_aos, DLED_WS2812B, leds, 255) == ESP_OK);
+    TEST_CHECK(dled_strip_create(&strip_soa, DLED_WS2812B, leds, 255) == ESP_OK);
+    randomize();
+
+    int64_t start = dled_port_time_us();
+    for (uint32_t i = 0; i < iterations; i++) dled_strip_fill_buffer_from_pixels(&strip_aos, aos);
+    int64_t aos_us = dled_port_time_us() - start;
+
+    start = dled_port_time_us();
+    for (uint32_t i = 0; i < iterations; i++) dled_strip_fill_buffer_from_planes(&strip_soa, &soa);
+    int64_t soa_us = dled_port_time_us() - start;
+
+    bool equal = true;
+    for (uint16_t i = 0; i < strip_aos.buffer_length; i++)
+        if (strip_aos.buffer[i] != strip_soa.buffer[i]) equal = false;
+    TEST_CHECK(equal);
+
+    printf("  %-12s AoS %6.2f ns/pixel, SoA %6.2f ns/pixel, AoS / SoA %.2f\n", "fill buffer",
+           ns_per_pixel(aos_us), ns_per_pixel(soa_us), (double)aos_us / (soa_us ? soa_us : 1));
+
+    dled_strip_destroy(&strip_aos);
+    dled_strip_destroy(&strip_soa);
+}
+
+int main(void)
+{
+    srand(1);
+    dled_planes_init(&soa);
+    dled_planes_init(&soa_src);
+    TEST_CHECK(dled_planes_create(&soa, leds) == ESP_OK);
+    TEST_CHECK(dled_planes_create(&soa_src, leds) == ESP_OK);
+
+    printf("  %d pixels, %d iterations\n", leds, iterations);
+    for (int kernel = FILL; kernel <= BLUR; kernel++) bench_kernel((kernel_t)kernel);
+    bench_fill_buffer();
+
+    dled_planes_destroy(&soa);
+    dled_planes_destroy(&soa_src);
+    return TEST_RESULT();
+}
@@ -0,0 +1,105 @@
+/*
+ * dled_encode_pool: encoding time of 8 strips against the number of workers.
+ * Every batch is compared with rmt_dled_encode, the benchmark fails on a difference.
+ * The speedup is bounded by the number of CPUs of the host, printed first.
+ */
+
+#include "dled_encode_pool.h"
+#include "dled_port.h"
+#include "dled_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STRIP_COUNT 8
+
+static const uint16_t leds = 1000;
+static const uint32_t iterations = 200;
+
+static pixel_strip_t strips[STRIP_COUNT];
+static rmt_pixel_strip_t rps[STRIP_COUNT];
+static rmt_pixel_strip_t *rps_ptr[STRIP_COUNT];
+static rmt_item32_t *expected[STRIP_COUNT];
+
+static uint32_t items_size(const rmt_pixel_strip_t *r)
+{
+    return (uint32_t)r->strip->buffer_length * 8 * sizeof(rmt_item32_t);
+}
+
+static void setup(void)
+{
+    for (int i = 0; i < STRIP_COUNT; i++) {
+        dled_strip_init(&strips[i]);
+        rmt_dled_init(&rps[i]);
+        TEST_CHECK(dled_strip_create(&strips[i], DLED_WS2812B, leds, 255) == ESP_OK);
+        dled_pixel_rainbow_step(strips[i].pixels, leds, 255, i * 17);
+        dled_strip_fill_buffer(&strips[i]);
+        TEST_CHECK(rmt_dled_create(&rps[i], &strips[i]) == ESP_OK);
+        rps_ptr[i] = &rps[i];
+
+        TEST_CHECK(rmt_dled_encode(&rps[i]) == ESP_OK);
+        expected[i] = (rmt_item32_t*)malloc(items_size(&rps[i]));
+        memcpy(expected[i], rps[i].ugly_buffer, items_size(&rps[i]));
+    }
+}
+
+static bool encoded_equal(void)
+{
+    for (int i = 0; i < STRIP_COUNT; i++)
+        if (memcmp(expected[i], rps[i].ugly_buffer, items_size(&rps[i])) != 0) return false;
+    return true;
+}
+
+static void clear_items(void)
+{
+    for (int i = 0; i < STRIP_COUNT; i++) {
+        memset(rps[i].ugly_buffer, 0, items_size(&rps[i]));
+        rps[i].encoded = false;
+    }
+}
+
+/* returns the time of one batch, in microseconds */
+static double bench(uint8_t workers, uint16_t chunk_bytes)
+{
+    dled_encode_pool_t pool;
+    dled_encode_pool_init(&pool);
+    TEST_CHECK(dled_encode_pool_create(&pool, workers, 256, chunk_bytes, 5) == ESP_OK);
+
+    clear_items();
+    TEST_CHECK(dled_encode_pool_encode_all(&pool, rps_ptr, STRIP_COUNT) == ESP_OK);
+    TEST_CHECK(encoded_equal());
+
+    int64_t start = dled_port_time_us();
+    for (uint32_t i = 0; i < iterations; i++) {
+        dled_encode_pool_encode_all(&pool, rps_ptr, STRIP_COUNT);
+    }
+    int64_t elapsed = dled_port_time_us() - start;
+    TEST_CHECK(encoded_equal());
+
+    dled_encode_pool_destroy(&pool);
+    return (double)elapsed / iterations;
+}
+
+int main(void)
+{
+    setup();
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("  %d strips of %d LEDs, %ld CPUs\n", STRIP_COUNT, leds, cpus);
+
+    /* one job per strip, then jobs of 300 bytes so a strip is also split */
+    const uint16_t chunks[2] = { 0, 300 };
+    for (int c = 0; c < 2; c++) {
+        double single = 0;
+        for (uint8_t workers = 0; workers <= 7; workers++) {
+            double us = bench(workers, chunks[c]);
+            if (workers == 0) single = us;
+            printf("  chunk %3d bytes, %d workers: %8.1f us per batch, speedup %.2f\n",
+                   chunks[c], workers, us, single / us);
+        }
+    }
+
+    for (int i = 0; i < STRIP_COUNT; i++) free(expected[i]);
+    return TEST_RESULT();
+}
@@ -0,0 +1,23 @@
+#ifndef HOST_DLED_TEST_H_
+#define HOST_DLED_TEST_H_
+
+/*
+ * Minimal checks for the host tests: a failed check is printed and counted,
+ * the test goes on and main returns TEST_RESULT().
+ */
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() \
+    (printf("%s: %s\n", __FILE__, (test_failures == 0) ? "ok" : "FAILED"), (test_failures == 0) ? 0 : 1)
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef HOST_STUBS_ESP_LOG_H_
+#define HOST_STUBS_ESP_LOG_H_
+
+/* Errors and warnings go to stderr, the other levels only with DLED_HOST_VERBOSE */
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+
+#ifdef DLED_HOST_VERBOSE
+#define ESP_LOGI(tag, format, ...) fprintf(stderr, "I %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) fprintf(stderr, "D %s: " format "\n", tag, ##__VA_ARGS__)
+#else
+#define ESP_LOGI(tag, format, ...) do { } while (0)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_STUBS_FREERTOS_H_
+#define HOST_STUBS_FREERTOS_H_
+
+/* Only the types needed by the driver stubs, the component uses POSIX on the host (see dled_port.h) */
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+#endif
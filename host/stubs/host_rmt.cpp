@@ -0,0 +1,217 @@
+#include "host_rmt.h"
+
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct host_channel_t {
+    bool installed = false;
+    uint8_t clk_div = 0;
+    uint32_t writes = 0;
+    std::vector<rmt_item32_t> items;
+};
+
+std::mutex host_mutex;
+host_channel_t host_channels[RMT_CHANNEL_MAX];
+int host_pins[GPIO_NUM_MAX];
+bool host_pins_ready = false;
+
+bool host_channel_valid(rmt_channel_t channel)
+{
+    return channel >= RMT_CHANNEL_0 && channel < RMT_CHANNEL_MAX;
+}
+
+bool host_pin_valid(gpio_num_t gpio_num)
+{
+    return gpio_num >= GPIO_NUM_0 && gpio_num < GPIO_NUM_MAX;
+}
+
+void host_pins_init()
+{
+    if (host_pins_ready) return;
+    for (int i = 0; i < GPIO_NUM_MAX; i++) host_pins[i] = -1;
+    host_pins_ready = true;
+}
+
+}
+
+extern "C" {
+
+void host_rmt_reset(void)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    for (int i = 0; i < RMT_CHANNEL_MAX; i++) host_channels[i] = host_channel_t();
+    host_pins_ready = false;
+    host_pins_init();
+}
+
+uint32_t host_rmt_write_count(rmt_channel_t channel)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    return host_channel_valid(channel) ? host_channels[channel].writes : 0;
+}
+
+uint32_t host_rmt_last_items(rmt_channel_t channel, const rmt_item32_t **items)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel)) { *items = NULL; return 0; }
+    *items = host_channels[channel].items.data();
+    return (uint32_t)host_channels[channel].items.size();
+}
+
+uint8_t host_rmt_clk_div(rmt_channel_t channel)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    return host_channel_valid(channel) ? host_channels[channel].clk_div : 0;
+}
+
+bool host_rmt_installed(rmt_channel_t channel)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    return host_channel_valid(channel) && host_channels[channel].installed;
+}
+
+int host_gpio_rmt_channel(gpio_num_t gpio_num)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    host_pins_init();
+    return host_pin_valid(gpio_num) ? host_pins[gpio_num] : -1;
+}
+
+/* GPIO driver */
+
+void gpio_pad_select_gpio(uint8_t gpio_num)
+{
+    (void)gpio_num;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    (void)mode;
+    return host_pin_valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    (void)level;
+    return host_pin_valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_pin_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    host_pins_init();
+    host_pins[gpio_num] = -1;
+    return ESP_OK;
+}
+
+/* RMT driver */
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel)
+{
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_tx_stop(rmt_channel_t channel)
+{
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_set_rx_intr_en(rmt_channel_t channel, bool en)
+{
+    (void)en;
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_set_err_intr_en(rmt_channel_t channel, bool en)
+{
+    (void)en;
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_set_tx_intr_en(rmt_channel_t channel, bool en)
+{
+    (void)en;
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_set_tx_thr_intr_en(rmt_channel_t channel, bool en, uint16_t evt_thresh)
+{
+    (void)en; (void)evt_thresh;
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_set_mem_pd(rmt_channel_t channel, bool pd_en)
+{
+    (void)pd_en;
+    return host_channel_valid(channel) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t rmt_set_clk_div(rmt_channel_t channel, uint8_t div_cnt)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel)) return ESP_ERR_INVALID_ARG;
+    host_channels[channel].clk_div = div_cnt;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_pin(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel) || mode != RMT_MODE_TX || !host_pin_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+    host_pins_init();
+    /* only connects the new pin, a previous pin keeps the signal */
+    host_pins[gpio_num] = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_config(const rmt_config_t *rmt_param)
+{
+    if (rmt_param == NULL) return ESP_ERR_INVALID_ARG;
+    esp_err_t ret_val = rmt_set_clk_div(rmt_param->channel, rmt_param->clk_div);
+    if (ret_val != ESP_OK) return ret_val;
+    return rmt_set_pin(rmt_param->channel, rmt_param->rmt_mode, rmt_param->gpio_num);
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags)
+{
+    (void)rx_buf_size; (void)intr_alloc_flags;
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel)) return ESP_ERR_INVALID_ARG;
+    if (host_channels[channel].installed) return ESP_ERR_INVALID_STATE;
+    host_channels[channel].installed = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel)
+{
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel)) return ESP_ERR_INVALID_ARG;
+    if (!host_channels[channel].installed) return ESP_ERR_INVALID_STATE;
+    host_channels[channel].installed = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *rmt_item, int item_num, bool wait_tx_done)
+{
+    (void)wait_tx_done;
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel) || rmt_item == NULL || item_num <= 0) return ESP_ERR_INVALID_ARG;
+    if (!host_channels[channel].installed) return ESP_ERR_INVALID_STATE;
+    host_channels[channel].items.assign(rmt_item, rmt_item + item_num);
+    host_channels[channel].writes++;
+    return ESP_OK;
+}
+
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time)
+{
+    (void)wait_time;
+    std::lock_guard<std::mutex> lock(host_mutex);
+    if (!host_channel_valid(channel)) return ESP_ERR_INVALID_ARG;
+    if (!host_channels[channel].installed) return ESP_ERR_INVALID_STATE;
+    return ESP_OK;
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef HOST_STUBS_HOST_RMT_H_
+#define HOST_STUBS_HOST_RMT_H_
+
+/*
+ * The RMT and GPIO driver stubs keep what a real ESP32 would output, the tests read it here.
+ * Like on the ESP32 a pin stays connected to its RMT channel in the GPIO matrix until gpio_reset_pin.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/rmt.h"
+
+/**
+ * @brief Forget all channels and pins.
+ */
+void host_rmt_reset(void);
+
+/**
+ * @brief Get the number of rmt_write_items calls of a channel.
+ */
+uint32_t host_rmt_write_count(rmt_channel_t channel);
+
+/**
+ * @brief Get the items of the last rmt_write_items call of a channel.
+ *
+ * @param[in]  channel The channel.
+ * @param[out] items   The items, valid until the next write on the channel.
+ *
+ * @return The number of items.
+ */
+uint32_t host_rmt_last_items(rmt_channel_t channel, const rmt_item32_t **items);
+
+/**
+ * @brief Get the clock divider of a channel.
+ */
+uint8_t host_rmt_clk_div(rmt_channel_t channel);
+
+/**
+ * @brief true if the driver of a channel is installed.
+ */
+bool host_rmt_installed(rmt_channel_t channel);
+
+/**
+ * @brief Get the RMT channel output on a pin, -1 if the pin is not connected to a RMT channel.
+ */
+int host_gpio_rmt_channel(gpio_num_t gpio_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef HOST_STUBS_SOC_RMT_STRUCT_H_
+#define HOST_STUBS_SOC_RMT_STRUCT_H_
+
+#include <stdint.h>
+
+typedef struct {
+    union {
+        struct {
+            uint32_t duration0 :15;
+            uint32_t level0 :1;
+            uint32_t duration1 :15;
+            uint32_t level1 :1;
+        };
+        uint32_t val;
+    };
+} rmt_item32_t;
+
+#endif
@@ -0,0 +1,265 @@
+/*
+ * dled_dmx: E1.31 and Art-Net packets built byte by byte as captured on the wire,
+ * then the same packets sent through a UDP socket on the loopback interface.
+ */
+
+#include "dled_dmx.h"
+#include "dled_test.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static void put_u16_be(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xff; }
+static void put_u32_be(uint8_t *p, uint32_t v) { put_u16_be(p, v >> 16); put_u16_be(p + 2, v & 0xffff); }
+static void put_flags_length(uint8_t *p, uint16_t length) { put_u16_be(p, 0x7000 | length); }
+
+/* E1.31 data packet, all layers as sent by a console; returns the packet length */
+static uint16_t e131_data(uint8_t *p, uint16_t universe, uint8_t sequence, uint8_t options,
+                          uint16_t sync_universe, const uint8_t *dmx, uint16_t channels)
+{
+    uint16_t length = 126 + channels;
+    memset(p, 0, length);
+
+    /* root layer */
+    put_u16_be(p + 0, 0x0010);
+    put_u16_be(p + 2, 0x0000);
+    memcpy(p + 4, "ASC-E1.17\0\0\0", 12);
+    put_flags_length(p + 16, length - 16);
+    put_u32_be(p + 18, 0x00000004);
+    for (int i = 0; i < 16; i++) p[22 + i] = (uint8_t)(0xc0 + i); /* CID */
+
+    /* framing layer */
+    put_flags_length(p + 38, length - 38);
+    put_u32_be(p + 40, 0x00000002);
+    strcpy((char*)p + 44, "host test console");
+    p[108] = 100; /* priority */
+    put_u16_be(p + 109, sync_universe);
+    p[111] = sequence;
+    p[112] = options;
+    put_u16_be(p + 113, universe);
+
+    /* DMP layer */
+    put_flags_length(p + 115, length - 115);
+    p[117] = 0x02;
+    p[118] = 0xa1;
+    put_u16_be(p + 119, 0x0000);
+    put_u16_be(p + 121, 0x0001);
+    put_u16_be(p + 123, channels + 1);
+    p[125] = 0x00; /* start code */
+    memcpy(p + 126, dmx, channels);
+
+    return length;
+}
+
+static uint16_t e131_sync(uint8_t *p, uint8_t sequence, uint16_t sync_universe)
+{
+    const uint16_t length = 49;
+    memset(p, 0, length);
+    put_u16_be(p + 0, 0x0010);
+    memcpy(p + 4, "ASC-E1.17\0\0\0", 12);
+    put_flags_length(p + 16, length - 16);
+    put_u32_be(p + 18, 0x00000008);
+    put_flags_length(p + 38, length - 38);
+    put_u32_be(p + 40, 0x00000001);
+    p[44] = sequence;
+    put_u16_be(p + 45, sync_universe);
+    return length;
+}
+
+static uint16_t artnet_dmx(uint8_t *p, uint16_t port_address, uint8_t sequence, const uint8_t *dmx, uint16_t channels)
+{
+    uint16_t length = 18 + channels;
+    memset(p, 0, length);
+    memcpy(p, "Art-Net\0", 8);
+    p[8] = 0x00; p[9] = 0x50;   /* OpDmx, little endian */
+    p[10] = 0; p[11] = 14;      /* protocol version */
+    p[12] = sequence;
+    p[13] = 0;                  /* physical */
+    p[14] = port_address & 0xff;
+    p[15] = (port_address >> 8) & 0x7f;
+    put_u16_be(p + 16, channels);
+    memcpy(p + 18, dmx, channels);
+    return length;
+}
+
+static uint16_t artnet_sync(uint8_t *p)
+{
+    memset(p, 0, 14);
+    memcpy(p, "Art-Net\0", 8);
+    p[8] = 0x00; p[9] = 0x52;
+    p[11] = 14;
+    return 14;
+}
+
+static pixel_strip_t strip;
+static dmx_universe_map_t maps[2];
+static dmx_receiver_t rx;
+static uint8_t dmx[512];
+static uint8_t packet[638];
+
+static void setup(void)
+{
+    dled_strip_destroy(&strip);
+    dled_strip_init(&strip);
+    dled_strip_create(&strip, DLED_WS281x, 200, 32);
+
+    /* 170 LEDs on universe 1, the next 30 on universe 2 */
+    dmx_universe_map_t m0 = { &strip, 1, 0, 0,   510, 0, false };
+    dmx_universe_map_t m1 = { &strip, 2, 0, 510, 90,  0, false };
+    maps[0] = m0;
+    maps[1] = m1;
+    TEST_CHECK(dled_dmx_init(&rx, maps, 2) == ESP_OK);
+
+    for (int i = 0; i < 512; i++) dmx[i] = (uint8_t)(i * 7);
+}
+
+static void test_e131(void)
+{
+    uint32_t ready = 0;
+    setup();
+
+    uint16_t len = e131_data(packet, 1, 10, 0, 0, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK);
+    TEST_CHECK(ready == 0x1);
+    TEST_CHECK(memcmp(strip.buffer, dmx, 510) == 0);
+
+    /* repeated sequence is dropped, 19 back too, 20 back is a restarted source */
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_ERR_INVALID_STATE);
+    len = e131_data(packet, 1, 10 - 19, 0, 0, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_ERR_INVALID_STATE);
+    TEST_CHECK(rx.out_of_sequence == 2);
+    len = e131_data(packet, 1, 10 - 20, 0, 0, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x1);
+
+    /* preview data is ignored */
+    strip.buffer[510] = 0x55;
+    len = e131_data(packet, 2, 1, 0x80, 0, dmx, 90);
+    ready = 0;
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+    TEST_CHECK(strip.buffer[510] == 0x55);
+
+    /* a short universe fills only the start of the map */
+    len = e131_data(packet, 2, 2, 0, 0, dmx, 10);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x2);
+    TEST_CHECK(memcmp(strip.buffer + 510, dmx, 10) == 0);
+
+    /* synchronized: both universes are held until the sync packet */
+    len = e131_data(packet, 1, 20, 0, 7000, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+    len = e131_data(packet, 2, 20, 0, 7000, dmx, 90);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+    TEST_CHECK(rx.pending == 0x3);
+    len = e131_sync(packet, 1, 7001);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+    len = e131_sync(packet, 1, 7000);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x3);
+    TEST_CHECK(rx.pending == 0);
+
+    /* sync packets stopped */
+    len = e131_data(packet, 1, 21, 0, 7000, dmx, 512);
+    dled_dmx_parse(&rx, packet, len, &ready);
+    TEST_CHECK(dled_dmx_reset_sync(&rx, &ready) == ESP_OK && ready == 0x1);
+
+    /* malformed packets */
+    uint32_t invalid = rx.invalid;
+    len = e131_data(packet, 1, 30, 0, 0, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, 100, &ready) == ESP_ERR_INVALID_RESPONSE);
+    packet[118] = 0x00;
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_ERR_INVALID_RESPONSE);
+    packet[0] = 0xff;
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_ERR_INVALID_RESPONSE);
+    TEST_CHECK(rx.invalid == invalid + 3);
+}
+
+static void test_artnet(void)
+{
+    uint32_t ready = 0;
+    setup();
+
+    uint16_t len = artnet_dmx(packet, 2, 1, dmx + 100, 90);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x2);
+    TEST_CHECK(memcmp(strip.buffer + 510, dmx + 100, 90) == 0);
+
+    /* sequence zero disables sequencing */
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_ERR_INVALID_STATE);
+    len = artnet_dmx(packet, 2, 0, dmx, 90);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x2);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x2);
+
+    /* not mapped: Net 1, universe 1 */
+    len = artnet_dmx(packet, 0x101, 5, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+
+    /* after an ArtSync the data is held until the next one */
+    len = artnet_sync(packet);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+    len = artnet_dmx(packet, 1, 2, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0);
+    len = artnet_sync(packet);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len, &ready) == ESP_OK && ready == 0x1);
+
+    /* length field larger than the packet */
+    len = artnet_dmx(packet, 1, 3, dmx, 512);
+    TEST_CHECK(dled_dmx_parse(&rx, packet, len - 1, &ready) == ESP_ERR_INVALID_RESPONSE);
+}
+
+/* the packets through a UDP socket, as the ESP32 receives them */
+static void test_udp_loopback(void)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) { printf("  UDP loopback skipped, no socket\n"); return; }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(sock, (struct sockaddr*)&addr, &addr_len) != 0) {
+        printf("  UDP loopback skipped, no loopback interface\n");
+        close(sock);
+        return;
+    }
+    struct timeval timeout = { 1, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    setup();
+    uint8_t received[638];
+    uint32_t ready_all = 0;
+
+    uint16_t len = e131_data(packet, 1, 1, 0, 0, dmx, 512);
+    sendto(sock, packet, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+    len = artnet_dmx(packet, 2, 1, dmx + 200, 90);
+    sendto(sock, packet, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+
+    for (int i = 0; i < 2; i++) {
+        ssize_t n = recv(sock, received, sizeof(received), 0);
+        TEST_CHECK(n > 0);
+        if (n <= 0) break;
+        uint32_t ready = 0;
+        TEST_CHECK(dled_dmx_parse(&rx, received, (uint16_t)n, &ready) == ESP_OK);
+        ready_all |= ready;
+    }
+    close(sock);
+
+    TEST_CHECK(ready_all == 0x3);
+    TEST_CHECK(memcmp(strip.buffer, dmx, 510) == 0);
+    TEST_CHECK(memcmp(strip.buffer + 510, dmx + 200, 90) == 0);
+}
+
+int main(void)
+{
+    dled_strip_init(&strip);
+
+    test_e131();
+    test_artnet();
+    test_udp_loopback();
+
+    dled_strip_destroy(&strip);
+    return TEST_RESULT();
+}
@@ -0,0 +1,251 @@
+/*
+ * dled_frame_queue: ordering, both full queue policies, the latency histogram and the
+ * sleeping waits, then a producer and a consumer thread hammering the queue.
+ */
+
+#include "dled_frame_queue.h"
+#include "dled_port.h"
+#include "dled_test.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+static const uint32_t frame_size = 64;
+
+/* every byte of a frame is derived from its sequence number, so torn frames are detected */
+static void fill_frame(uint8_t *frame, uint32_t seq)
+{
+    memcpy(frame, &seq, sizeof(seq));
+    for (uint32_t i = sizeof(seq); i < frame_size; i++)
+        frame[i] = (uint8_t)(seq * 31 + i);
+}
+
+static bool check_frame(const uint8_t *frame, uint32_t *seq)
+{
+    memcpy(seq, frame, sizeof(*seq));
+    for (uint32_t i = sizeof(*seq); i < frame_size; i++)
+        if (frame[i] != (uint8_t)(*seq * 31 + i)) return false;
+    return true;
+}
+
+static uint8_t latency_bucket(int64_t latency)
+{
+    uint8_t bucket = 0;
+    while (latency > 0 && bucket < DLED_FQ_HISTOGRAM_SIZE - 1) { latency >>= 1; bucket++; }
+    return bucket;
+}
+
+static uint32_t histogram_sum(const dled_frame_queue_t *queue)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < DLED_FQ_HISTOGRAM_SIZE; i++) sum += queue->latency_histogram[i];
+    return sum;
+}
+
+static void test_order_and_drop_oldest(void)
+{
+    dled_frame_queue_t queue;
+    dled_frame_queue_init(&queue);
+    TEST_CHECK(dled_frame_queue_create(&queue, 3, frame_size, DLED_FQ_DROP_OLDEST) == ESP_OK);
+
+    TEST_CHECK(dled_frame_queue_acquire(&queue) == NULL);
+
+    /* 5 frames in a queue of 3, the first 2 are dropped */
+    for (uint32_t seq = 0; seq < 5; seq++) {
+        fill_frame(dled_frame_queue_producer_frame(&queue), seq);
+        TEST_CHECK(dled_frame_queue_publish(&queue) == ESP_OK);
+    }
+    TEST_CHECK(queue.overruns == 2);
+
+    for (uint32_t expected = 2; expected < 5; expected++) {
+        uint8_t *frame = dled_frame_queue_acquire(&queue);
+        uint32_t seq = 0;
+        TEST_CHECK(frame != NULL && check_frame(frame, &seq) && seq == expected);
+    }
+    TEST_CHECK(dled_frame_queue_acquire(&queue) == NULL);
+    TEST_CHECK(queue.consumed == 3 && queue.published == 5);
+
+    dled_frame_queue_destroy(&queue);
+}
+
+static void test_latency_histogram(void)
+{
+    dled_frame_queue_t queue;
+    dled_frame_queue_init(&queue);
+    TEST_CHECK(dled_frame_queue_create(&queue, 2, frame_size, DLED_FQ_BLOCK) == ESP_OK);
+
+    fill_frame(dled_frame_queue_producer_frame(&queue), 0);
+    dled_frame_queue_publish(&queue);
+    dled_port_delay_ms(3);
+    TEST_CHECK(dled_frame_queue_acquire(&queue) != NULL);
+    dled_frame_queue_release(&queue);
+
+    TEST_CHECK(queue.latency_max >= 3000);
+    TEST_CHECK(histogram_sum(&queue) == 1);
+    TEST_CHECK(queue.latency_histogram[latency_bucket(queue.latency_max)] == 1);
+    /* 3 ms is in the [2048, 4096) us bucket or above */
+    TEST_CHECK(latency_bucket(queue.latency_max) >= 12);
+
+    dled_frame_queue_destroy(&queue);
+}
+
+/* CPU time of the calling thread, a sleeping thread does not use any */
+static int64_t thread_cpu_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+typedef struct {
+    dled_frame_queue_t *queue;
+    bool result;
+    int64_t cpu_us;
+} sleeper_arg_t;
+
+static void* sleeping_consumer(void *arg)
+{
+    sleeper_arg_t *sa = (sleeper_arg_t*)arg;
+    int64_t cpu = thread_cpu_us();
+    sa->result = dled_frame_queue_wait(sa->queue);
+    sa->cpu_us = thread_cpu_us() - cpu;
+    return NULL;
+}
+
+static void* sleeping_producer(void *arg)
+{
+    sleeper_arg_t *sa = (sleeper_arg_t*)arg;
+    int64_t cpu = thread_cpu_us();
+    sa->result = (dled_frame_queue_publish(sa->queue) == ESP_OK);
+    sa->cpu_us = thread_cpu_us() - cpu;
+    return NULL;
+}
+
+/* the waiting side sleeps on its semaphore instead of polling */
+static void test_sleeping_waits(void)
+{
+    dled_frame_queue_t queue;
+    dled_frame_queue_init(&queue);
+    TEST_CHECK(dled_frame_queue_create(&queue, 1, frame_size, DLED_FQ_BLOCK) == ESP_OK);
+    pthread_t thread;
+    sleeper_arg_t sa = { &queue, false, 0 };
+
+    /* consumer waiting for a frame */
+    pthread_create(&thread, NULL, sleeping_consumer, &sa);
+    dled_port_delay_ms(100);
+    fill_frame(dled_frame_queue_producer_frame(&queue), 1);
+    TEST_CHECK(dled_frame_queue_publish(&queue) == ESP_OK);
+    pthread_join(thread, NULL);
+    TEST_CHECK(sa.result);
+    TEST_CHECK(sa.cpu_us < 20000);
+
+    /* producer blocked on the full queue */
+    pthread_create(&thread, NULL, sleeping_producer, &sa);
+    dled_port_delay_ms(100);
+    uint32_t seq;
+    uint8_t *frame = dled_frame_queue_acquire(&queue);
+    TEST_CHECK(frame != NULL && check_frame(frame, &seq) && seq == 1);
+    pthread_join(thread, NULL);
+    TEST_CHECK(sa.result);
+    TEST_CHECK(sa.cpu_us < 20000);
+    TEST_CHECK(queue.overruns == 1);
+    TEST_CHECK(dled_frame_queue_acquire(&queue) != NULL);
+
+    /* consumer woken up on an empty queue */
+    pthread_create(&thread, NULL, sleeping_consumer, &sa);
+    dled_port_delay_ms(20);
+    dled_frame_queue_wakeup(&queue);
+    pthread_join(thread, NULL);
+    TEST_CHECK(!sa.result);
+
+    /* a wakeup before the wait is not lost */
+    dled_frame_queue_wakeup(&queue);
+    TEST_CHECK(!dled_frame_queue_wait(&queue));
+
+    dled_frame_queue_destroy(&queue);
+}
+
+typedef struct {
+    dled_frame_queue_t *queue;
+    uint32_t frames;
+    volatile bool done;
+} stress_arg_t;
+
+static void* stress_producer(void *arg)
+{
+    stress_arg_t *sa = (stress_arg_t*)arg;
+    for (uint32_t seq = 0; seq < sa->frames; seq++) {
+        fill_frame(dled_frame_queue_producer_frame(sa->queue), seq);
+        dled_frame_queue_publish(sa->queue);
+        if ((seq & 63) == 0) dled_port_yield();
+    }
+    __atomic_store_n(&sa->done, true, __ATOMIC_RELEASE);
+    dled_frame_queue_wakeup(sa->queue);
+    return NULL;
+}
+
+static void stress(dled_fq_policy_t policy, uint16_t capacity)
+{
+    dled_frame_queue_t queue;
+    dled_frame_queue_init(&queue);
+    TEST_CHECK(dled_frame_queue_create(&queue, capacity, frame_size, policy) == ESP_OK);
+
+    stress_arg_t sa = { &queue, 200000, false };
+    pthread_t producer;
+    pthread_create(&producer, NULL, stress_producer, &sa);
+
+    uint32_t torn = 0, out_of_order = 0, received = 0;
+    int64_t last = -1;
+    while (true) {
+        bool done = __atomic_load_n(&sa.done, __ATOMIC_ACQUIRE);
+        uint8_t *frame = dled_frame_queue_acquire(&queue);
+        if (frame == NULL) {
+            if (done) break;
+            dled_frame_queue_wait(&queue);
+            continue;
+        }
+        uint32_t seq;
+        if (!check_frame(frame, &seq)) torn++;
+        if ((int64_t)seq <= last) out_of_order++;
+        if (policy == DLED_FQ_BLOCK && (int64_t)seq != last + 1) out_of_order++;
+        last = seq;
+        received++;
+    }
+    dled_frame_queue_release(&queue);
+    pthread_join(producer, NULL);
+
+    TEST_CHECK(torn == 0);
+    TEST_CHECK(out_of_order == 0);
+    TEST_CHECK(queue.published == sa.frames);
+    TEST_CHECK(queue.consumed == received);
+    TEST_CHECK(last == (int64_t)sa.frames - 1);
+    if (policy == DLED_FQ_BLOCK) {
+        TEST_CHECK(received == sa.frames);
+    }
+    else {
+        TEST_CHECK(received + queue.overruns == sa.frames);
+    }
+    TEST_CHECK(histogram_sum(&queue) == received);
+    TEST_CHECK(queue.latency_histogram[latency_bucket(queue.latency_max)] > 0);
+
+    printf("  %s capacity %d: %u frames, %u received, %u overruns, max latency %lld us\n",
+           (policy == DLED_FQ_BLOCK) ? "block" : "drop oldest", capacity, sa.frames, received,
+           queue.overruns, (long long)queue.latency_max);
+
+    dled_frame_queue_destroy(&queue);
+}
+
+int main(void)
+{
+    test_order_and_drop_oldest();
+    test_latency_histogram();
+    test_sleeping_waits();
+
+    stress(DLED_FQ_DROP_OLDEST, 1);
+    stress(DLED_FQ_DROP_OLDEST, 3);
+    stress(DLED_FQ_BLOCK, 1);
+    stress(DLED_FQ_BLOCK, 3);
+
+    return TEST_RESULT();
+}
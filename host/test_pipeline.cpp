@@ -0,0 +1,216 @@
+/*
+ * dled_pipeline: a sink output stage checks that every rendered frame is sent in order
+ * with DLED_FQ_BLOCK, then the RMT output stage runs on the driver stubs.
+ */
+
+#include "dled_pipeline.h"
+#include "dled_port.h"
+#include "dled_test.h"
+#include "host_rmt.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t leds = 16;
+static const uint32_t frames_to_send = 500;
+
+/* all pixels of a frame are derived from its index */
+static void render_index(pixel_t *pixels, uint16_t length, uint8_t max_cc_val, uint32_t frame, void * /* arg */)
+{
+    for (uint16_t i = 0; i < length; i++)
+        dled_pixel_set(&pixels[i], (uint8_t)frame, (uint8_t)(frame >> 8), (uint8_t)((frame + i) % (max_cc_val + 1)));
+}
+
+typedef struct {
+    pixel_t buffers[2][leds];
+    int8_t  sending;          /* buffer being sent, -1 if none */
+    uint32_t sent;            /* frames seen by send */
+    uint32_t out_of_order;    /* frames which are not the next one */
+    uint32_t busy_buffer;     /* encodes in the buffer being sent */
+    uint32_t unwaited;        /* sends while a transmission was pending */
+    uint32_t fail_every;      /* every fail_every-th send fails, 0 for none */
+    uint32_t failed;          /* sends which failed */
+    bool stopped;
+} sink_t;
+
+static esp_err_t sink_encode(void *arg, const pixel_t *pixels, uint8_t buffer)
+{
+    sink_t *sink = (sink_t*)arg;
+    if (sink->sending == buffer) sink->busy_buffer++;
+    memcpy(sink->buffers[buffer], pixels, sizeof(sink->buffers[buffer]));
+    return ESP_OK;
+}
+
+static esp_err_t sink_send(void *arg, uint8_t buffer)
+{
+    sink_t *sink = (sink_t*)arg;
+    if (sink->sending >= 0) sink->unwaited++;
+
+    pixel_t expected[leds];
+    render_index(expected, leds, 255, sink->sent, NULL);
+    if (memcmp(expected, sink->buffers[buffer], sizeof(expected)) != 0) sink->out_of_order++;
+
+    sink->sent++;
+    if (sink->fail_every != 0 && sink->sent % sink->fail_every == 0) {
+        sink->failed++;
+        return ESP_FAIL;
+    }
+    sink->sending = buffer;
+    return ESP_OK;
+}
+
+static esp_err_t sink_wait(void *arg)
+{
+    sink_t *sink = (sink_t*)arg;
+    sink->sending = -1;
+    return ESP_OK;
+}
+
+static void sink_stop(void *arg)
+{
+    sink_t *sink = (sink_t*)arg;
+    sink->stopped = true;
+}
+
+static void wait_frames_sent(dled_pipeline_t *pipeline, uint32_t count)
+{
+    int64_t start = dled_port_time_us();
+    while (__atomic_load_n(&pipeline->frames_sent, __ATOMIC_RELAXED) < count && dled_port_time_us() - start < 10000000)
+        dled_port_delay_ms(1);
+}
+
+static void test_sink(uint16_t capacity)
+{
+    sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.sending = -1;
+
+    dled_output_t output;
+    output.encode = sink_encode;
+    output.send = sink_send;
+    output.wait = sink_wait;
+    output.stop = sink_stop;
+    output.arg = &sink;
+
+    dled_pipeline_t pipeline;
+    dled_pipeline_init(&pipeline);
+    TEST_CHECK(dled_pipeline_create_with_output(&pipeline, &output, leds, 255, render_index, NULL,
+                                                capacity, DLED_FQ_BLOCK) == ESP_OK);
+    TEST_CHECK(dled_pipeline_start(&pipeline, -1, -1, 5) == ESP_OK);
+    wait_frames_sent(&pipeline, frames_to_send);
+    TEST_CHECK(dled_pipeline_stop(&pipeline) == ESP_OK);
+
+    TEST_CHECK(pipeline.frames_sent >= frames_to_send);
+    TEST_CHECK(sink.sent == pipeline.frames_sent);
+    TEST_CHECK(pipeline.frames_failed == 0);
+    TEST_CHECK(sink.sent <= pipeline.frames_rendered);
+    TEST_CHECK(sink.out_of_order == 0);
+    TEST_CHECK(sink.busy_buffer == 0);
+    TEST_CHECK(sink.unwaited == 0);
+    TEST_CHECK(sink.sending == -1);
+    TEST_CHECK(sink.stopped);
+    TEST_CHECK(pipeline.output_error == ESP_OK);
+
+    TEST_CHECK(dled_pipeline_destroy(&pipeline) == ESP_OK);
+}
+
+/* frames the output stage fails to send are not counted as sent */
+static void test_failing_output(void)
+{
+    sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.sending = -1;
+    sink.fail_every = 4;
+
+    dled_output_t output;
+    output.encode = sink_encode;
+    output.send = sink_send;
+    output.wait = sink_wait;
+    output.stop = sink_stop;
+    output.arg = &sink;
+
+    dled_pipeline_t pipeline;
+    dled_pipeline_init(&pipeline);
+    TEST_CHECK(dled_pipeline_create_with_output(&pipeline, &output, leds, 255, render_index, NULL,
+                                                2, DLED_FQ_BLOCK) == ESP_OK);
+    TEST_CHECK(dled_pipeline_start(&pipeline, -1, -1, 5) == ESP_OK);
+    wait_frames_sent(&pipeline, frames_to_send);
+    TEST_CHECK(dled_pipeline_stop(&pipeline) == ESP_OK);
+
+    TEST_CHECK(sink.failed != 0);
+    TEST_CHECK(pipeline.frames_sent == sink.sent - sink.failed);
+    TEST_CHECK(pipeline.frames_failed == sink.failed);
+    TEST_CHECK(sink.out_of_order == 0);
+    TEST_CHECK(sink.busy_buffer == 0);
+    TEST_CHECK(pipeline.output_error == ESP_FAIL);
+
+    TEST_CHECK(dled_pipeline_destroy(&pipeline) == ESP_OK);
+}
+
+static void test_invalid_output(void)
+{
+    dled_output_t output;
+    memset(&output, 0, sizeof(output));
+    output.encode = sink_encode;
+    output.send = sink_send;
+
+    dled_pipeline_t pipeline;
+    dled_pipeline_init(&pipeline);
+    TEST_CHECK(dled_pipeline_create_with_output(&pipeline, &output, leds, 255, render_index, NULL,
+                                                2, DLED_FQ_BLOCK) == ESP_ERR_INVALID_ARG);
+    TEST_CHECK(dled_pipeline_start(&pipeline, -1, -1, 5) == ESP_ERR_INVALID_STATE);
+}
+
+static void test_rmt_output(void)
+{
+    host_rmt_reset();
+
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_strip_init(&strip);
+    rmt_dled_init(&rps);
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, leds, 255) == ESP_OK);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_OK);
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_18, RMT_CHANNEL_0) == ESP_OK);
+    rmt_item32_t *own_items = rps.ugly_buffer;
+
+    dled_pipeline_t pipeline;
+    dled_pipeline_init(&pipeline);
+    TEST_CHECK(dled_pipeline_create(&pipeline, &rps, render_index, NULL, 2, DLED_FQ_BLOCK) == ESP_OK);
+    TEST_CHECK(dled_pipeline_start(&pipeline, -1, -1, 5) == ESP_OK);
+    wait_frames_sent(&pipeline, 50);
+    TEST_CHECK(dled_pipeline_stop(&pipeline) == ESP_OK);
+
+    uint32_t sent = pipeline.frames_sent;
+    TEST_CHECK(sent >= 50);
+    TEST_CHECK(host_rmt_write_count(RMT_CHANNEL_0) == sent);
+    TEST_CHECK(pipeline.output_error == ESP_OK);
+    TEST_CHECK(rps.ugly_buffer == own_items);
+    TEST_CHECK(!rps.encoded);
+
+    /* the last items on the wire are the encoding of the last frame */
+    const rmt_item32_t *items;
+    uint32_t count = host_rmt_last_items(RMT_CHANNEL_0, &items);
+    TEST_CHECK(count == (uint32_t)strip.buffer_length * 8);
+    render_index(strip.pixels, leds, strip.max_cc_val, sent - 1, NULL);
+    dled_strip_fill_buffer(&strip);
+    TEST_CHECK(rmt_dled_encode(&rps) == ESP_OK);
+    TEST_CHECK(count != 0 && memcmp(items, rps.ugly_buffer, count * sizeof(rmt_item32_t)) == 0);
+
+    TEST_CHECK(dled_pipeline_destroy(&pipeline) == ESP_OK);
+    TEST_CHECK(pipeline.items[1] == NULL);
+
+    free(rps.ugly_buffer);
+    rmt_dled_init(&rps);
+    dled_strip_destroy(&strip);
+}
+
+int main(void)
+{
+    test_sink(1);
+    test_sink(3);
+    test_failing_output();
+    test_invalid_output();
+    test_rmt_output();
+    return TEST_RESULT();
+}
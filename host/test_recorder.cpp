@@ -0,0 +1,247 @@
+/*
+ * dled_recorder and dled_replay: frames sent through rmt_dled_send are captured, dumped
+ * and replayed on the wire simulator; damaged dumps are reported and frames sent with
+ * other timings are not dumped.
+ */
+
+#include "dled_recorder.h"
+#include "dled_replay.h"
+#include "dled_wire_sim.h"
+#include "esp32_rmt_dled.h"
+#include "dled_test.h"
+#include "host_rmt.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static std::vector<uint8_t> dump;
+
+static esp_err_t write_dump(const void *data, size_t length, void *arg)
+{
+    (void)arg;
+    dump.insert(dump.end(), (const uint8_t*)data, (const uint8_t*)data + length);
+    return ESP_OK;
+}
+
+static esp_err_t write_fail(const void *data, size_t length, void *arg)
+{
+    (void)data; (void)length;
+    int *calls = (int*)arg;
+    return (++*calls == 2) ? ESP_FAIL : ESP_OK;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static void test_round_trip(void)
+{
+    host_rmt_reset();
+
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_recorder_t rec;
+    dled_strip_init(&strip);
+    rmt_dled_init(&rps);
+    dled_recorder_init(&rec);
+
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, 20, 255) == ESP_OK);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_OK);
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_18, RMT_CHANNEL_0) == ESP_OK);
+    TEST_CHECK(dled_recorder_create(&rec, &strip, 3) == ESP_OK);
+    rps.recorder = &rec;
+
+    /* 5 frames in a ring of 3, the strip shrinks before the fourth */
+    uint8_t frames[5][60];
+    for (int f = 0; f < 5; f++) {
+        if (f == 3) TEST_CHECK(rmt_dled_resize(&rps, 12) == ESP_OK);
+        dled_pixel_rainbow_step(strip.pixels, strip.length, 255, f * 7);
+        dled_strip_fill_buffer(&strip);
+        memcpy(frames[f], strip.buffer, strip.buffer_length);
+        TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    }
+    TEST_CHECK(rec.recorded == 5);
+    TEST_CHECK(dled_recorder_count(&rec) == 3);
+
+    /* disabled: nothing is captured */
+    dled_recorder_enable(&rec, false);
+    TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    TEST_CHECK(rec.recorded == 5);
+
+    dump.clear();
+    TEST_CHECK(dled_recorder_dump(&rec, write_dump, NULL) == ESP_OK);
+    TEST_CHECK(dump.size() == DLED_RECORDER_HEADER_SIZE + 3 * DLED_RECORDER_FRAME_HEADER_SIZE + 60 + 36 + 36);
+    TEST_CHECK(memcmp(dump.data(), "DLRC", 4) == 0);
+    TEST_CHECK(get32(&dump[24]) == 3);
+
+    /* oldest first: frames 2, 3 and 4 */
+    const uint8_t *p = dump.data() + DLED_RECORDER_HEADER_SIZE;
+    TEST_CHECK(get32(p + 8) == 60);
+    TEST_CHECK(memcmp(p + DLED_RECORDER_FRAME_HEADER_SIZE, frames[2], 60) == 0);
+    p += DLED_RECORDER_FRAME_HEADER_SIZE + 60;
+    TEST_CHECK(get32(p + 8) == 36);
+    TEST_CHECK(memcmp(p + DLED_RECORDER_FRAME_HEADER_SIZE, frames[3], 36) == 0);
+
+    dled_replay_result_t result;
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_OK);
+    TEST_CHECK(result.frames == 3);
+    TEST_CHECK(result.mismatches == 0);
+    TEST_CHECK(result.violations == 0);
+    TEST_CHECK(result.first_bad_frame == -1);
+    TEST_CHECK(result.max_wire_time_ps > 280000000ULL);
+
+    /* a write error stops the dump */
+    int calls = 0;
+    TEST_CHECK(dled_recorder_dump(&rec, write_fail, &calls) == ESP_FAIL);
+    TEST_CHECK(calls == 2);
+
+    dled_recorder_destroy(&rec);
+    rps.recorder = NULL;
+    free(rps.ugly_buffer);
+    dled_strip_destroy(&strip);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* frames sent before a change of type or timings are not replayed with the new ones */
+static void test_timing_change(void)
+{
+    host_rmt_reset();
+
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_recorder_t rec;
+    dled_strip_init(&strip);
+    rmt_dled_init(&rps);
+    dled_recorder_init(&rec);
+
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, 20, 255) == ESP_OK);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_OK);
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_18, RMT_CHANNEL_0) == ESP_OK);
+    TEST_CHECK(dled_recorder_create(&rec, &strip, 4) == ESP_OK);
+    rps.recorder = &rec;
+
+    dled_replay_result_t result;
+    for (int f = 0; f < 3; f++) {
+        dled_pixel_rainbow_step(strip.pixels, strip.length, 255, f);
+        dled_strip_fill_buffer(&strip);
+        TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    }
+
+    TEST_CHECK(rmt_dled_set_type(&rps, DLED_WS2812B_FAST) == ESP_OK);
+    for (int f = 0; f < 2; f++) {
+        dled_pixel_rainbow_step(strip.pixels, strip.length, 255, f + 5);
+        dled_strip_fill_buffer(&strip);
+        TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    }
+    TEST_CHECK(dled_recorder_count(&rec) == 2);
+
+    dump.clear();
+    TEST_CHECK(dled_recorder_dump(&rec, write_dump, NULL) == ESP_OK);
+    TEST_CHECK(dump[5] == DLED_WS2812B_FAST);
+    TEST_CHECK(get16(&dump[8]) == strip.T0H && get16(&dump[10]) == strip.T0L);
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_OK);
+    TEST_CHECK(result.frames == 2);
+    TEST_CHECK(result.mismatches == 0 && result.violations == 0);
+
+    /* custom timings clear the ring too, a resize does not */
+    TEST_CHECK(rmt_dled_resize(&rps, 10) == ESP_OK);
+    TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    TEST_CHECK(dled_recorder_count(&rec) == 3);
+    TEST_CHECK(dled_strip_set_custom_timings(&strip, 300, 700, 700, 300, 280000) == ESP_OK);
+    rmt_dled_set_items(&rps);
+    TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    TEST_CHECK(dled_recorder_count(&rec) == 1);
+
+    dump.clear();
+    TEST_CHECK(dled_recorder_dump(&rec, write_dump, NULL) == ESP_OK);
+    TEST_CHECK(get16(&dump[10]) == 700 && get16(&dump[14]) == 300);
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_OK);
+    TEST_CHECK(result.frames == 1);
+    TEST_CHECK(result.mismatches == 0 && result.violations == 0);
+
+    dled_recorder_destroy(&rec);
+    rps.recorder = NULL;
+    free(rps.ugly_buffer);
+    dled_strip_destroy(&strip);
+}
+
+static void test_damaged_dumps(void)
+{
+    std::vector<uint8_t> good = dump;
+    dled_replay_result_t result;
+
+    /* recorded with a 100 ns T0H, out of the WS2812B datasheet */
+    dump[8] = 100; dump[9] = 0;
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_OK);
+    TEST_CHECK(result.frames == 3);
+    TEST_CHECK(result.violations != 0);
+    TEST_CHECK((result.violation_flags & DLED_SIM_HIGH_INVALID) != 0);
+    TEST_CHECK(result.first_bad_frame == 0);
+
+    dump = good;
+    TEST_CHECK(dled_replay(dump.data(), dump.size() - 3, &result) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(dled_replay(dump.data(), DLED_RECORDER_HEADER_SIZE - 1, &result) == ESP_ERR_INVALID_VERSION);
+
+    dump[0] = 'X';
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_ERR_INVALID_VERSION);
+
+    dump = good;
+    dump[DLED_RECORDER_HEADER_SIZE + 8] = 61; /* frame length not a multiple of 3 */
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_ERR_INVALID_SIZE);
+
+    TEST_CHECK(dled_replay(NULL, 0, &result) == ESP_ERR_INVALID_ARG);
+
+    /* truncated in a frame header, in the last frame, and fewer frames than counted */
+    TEST_CHECK(dled_replay(good.data(), DLED_RECORDER_HEADER_SIZE + 5, &result) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(dled_replay(good.data(), DLED_RECORDER_HEADER_SIZE + DLED_RECORDER_FRAME_HEADER_SIZE + 30, &result) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(dled_replay(good.data(), good.size() - 36, &result) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(result.frames == 2);
+    dump = good;
+    put32(&dump[24], 4);
+    TEST_CHECK(dled_replay(dump.data(), dump.size(), &result) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(result.frames == 3);
+
+    /* a well formed dump of 30000 LEDs: the buffer would not fit dled_strip_create's 16 bit sizes */
+    const uint32_t big = 30000 * 3;
+    std::vector<uint8_t> oversized(good.begin(), good.begin() + DLED_RECORDER_HEADER_SIZE);
+    put32(&oversized[20], big);
+    put32(&oversized[24], 1);
+    oversized.resize(DLED_RECORDER_HEADER_SIZE + DLED_RECORDER_FRAME_HEADER_SIZE + big, 0x5a);
+    put32(&oversized[DLED_RECORDER_HEADER_SIZE], 0);
+    put32(&oversized[DLED_RECORDER_HEADER_SIZE + 4], 0);
+    put32(&oversized[DLED_RECORDER_HEADER_SIZE + 8], big);
+    TEST_CHECK(dled_replay(oversized.data(), oversized.size(), &result) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(result.frames == 0);
+
+    /* a frame size which fits, with a frame longer than it */
+    put32(&oversized[20], 21845 * 3);
+    TEST_CHECK(dled_replay(oversized.data(), oversized.size(), &result) == ESP_ERR_INVALID_SIZE);
+
+    pixel_strip_t strip;
+    dled_strip_init(&strip);
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, 30000, 255) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(strip.buffer == NULL && strip.pixels == NULL);
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, 10, 255) == ESP_OK);
+    TEST_CHECK(dled_strip_resize(&strip, 21846) == ESP_ERR_INVALID_SIZE);
+    TEST_CHECK(strip.length == 10);
+    dled_strip_destroy(&strip);
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_damaged_dumps();
+    test_timing_change();
+    return TEST_RESULT();
+}
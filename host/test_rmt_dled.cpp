@@ -0,0 +1,218 @@
+/*
+ * esp32_rmt_dled: the clock divider and frame time of the strip types, resizing and
+ * reconfiguring a strip, checked against a full encoding and against the RMT and GPIO driver stubs.
+ */
+
+#include "esp32_rmt_dled.h"
+#include "dled_test.h"
+#include "host_rmt.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* compares `ugly_buffer` with a full encoding, leaves the full encoding */
+static bool same_as_full_encode(rmt_pixel_strip_t *rps)
+{
+    uint32_t count = (uint32_t)rps->strip->buffer_length * 8;
+    rmt_item32_t *items = (rmt_item32_t*)malloc(count * sizeof(rmt_item32_t));
+    memcpy(items, rps->ugly_buffer, count * sizeof(rmt_item32_t));
+
+    rmt_dled_encode(rps);
+    bool same = (memcmp(items, rps->ugly_buffer, count * sizeof(rmt_item32_t)) == 0);
+    free(items);
+    return same;
+}
+
+static void create(pixel_strip_t *strip, rmt_pixel_strip_t *rps, uint16_t length, uint8_t value)
+{
+    dled_strip_init(strip);
+    rmt_dled_init(rps);
+    TEST_CHECK(dled_strip_create(strip, DLED_WS2812B, length, 255) == ESP_OK);
+    dled_pixel_fill(strip->pixels, length, value, value, value);
+    dled_strip_fill_buffer(strip);
+    TEST_CHECK(rmt_dled_create(rps, strip) == ESP_OK);
+    TEST_CHECK(rmt_dled_encode(rps) == ESP_OK);
+}
+
+static void destroy(pixel_strip_t *strip, rmt_pixel_strip_t *rps)
+{
+    free(rps->ugly_buffer);
+    rmt_dled_init(rps);
+    dled_strip_destroy(strip);
+}
+
+static void test_select_divider(void)
+{
+    pixel_strip_t strip;
+    uint8_t clk_div;
+    uint32_t error_ps;
+    dled_strip_init(&strip);
+
+    /* WS2812B at 12.5 ns: T0L and T1H are 87.2 ticks, T1L is 25.6 ticks; 2.5 + 2.5 + 5 ns */
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, 10, 255) == ESP_OK);
+    TEST_CHECK(rmt_dled_select_divider(&strip, &clk_div, &error_ps) == ESP_OK);
+    TEST_CHECK(clk_div == 1);
+    TEST_CHECK(error_ps == 10000);
+    dled_strip_destroy(&strip);
+
+    /* the fast profile is a multiple of 12.5 ns */
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B_FAST, 10, 255) == ESP_OK);
+    TEST_CHECK(rmt_dled_select_divider(&strip, &clk_div, &error_ps) == ESP_OK);
+    TEST_CHECK(clk_div == 1);
+    TEST_CHECK(error_ps == 0);
+
+    /* a 500 us reset does not fit 15 bits below divider 2, divider 3 has the smallest error:
+     * 37.5 ns ticks give 0 + 2.5 + 2.5 + 17.5 ns, 25 ns ticks 0 + 10 + 10 + 5 ns */
+    TEST_CHECK(dled_strip_set_custom_timings(&strip, 300, 1090, 1090, 320, 500000) == ESP_OK);
+    TEST_CHECK(rmt_dled_select_divider(&strip, &clk_div, &error_ps) == ESP_OK);
+    TEST_CHECK(clk_div == 3);
+    TEST_CHECK(error_ps == 22500);
+
+    /* 60 ms needs divider 147 or more, where T0H is less than half a tick */
+    TEST_CHECK(dled_strip_set_custom_timings(&strip, 300, 1090, 1090, 320, 60000000) == ESP_OK);
+    TEST_CHECK(rmt_dled_select_divider(&strip, &clk_div, &error_ps) == ESP_ERR_INVALID_ARG);
+
+    /* 110 ms is more than 32767 ticks of 255 * 12.5 ns, whatever the bits */
+    TEST_CHECK(dled_strip_set_custom_timings(&strip, 60000, 60000, 60000, 60000, 110000000) == ESP_OK);
+    TEST_CHECK(rmt_dled_select_divider(&strip, &clk_div, &error_ps) == ESP_ERR_INVALID_ARG);
+
+    rmt_pixel_strip_t rps;
+    rmt_dled_init(&rps);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_ERR_INVALID_ARG);
+    TEST_CHECK(rps.ugly_buffer == NULL);
+    TEST_CHECK(rmt_dled_select_divider(NULL, &clk_div, &error_ps) == ESP_ERR_INVALID_ARG);
+    dled_strip_destroy(&strip);
+}
+
+static void test_reset_rounding(void)
+{
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_strip_init(&strip);
+    rmt_dled_init(&rps);
+
+    /* 50001 ns is 4000.08 ticks, the reset is never shortened */
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812, 10, 255) == ESP_OK);
+    TEST_CHECK(dled_strip_set_custom_timings(&strip, 350, 800, 700, 600, 50001) == ESP_OK);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_OK);
+    TEST_CHECK(rps.clk_div == 1);
+    TEST_CHECK(rps.rmtLR.duration1 == 4001);
+    TEST_CHECK(rps.rmtHR.duration1 == 4001);
+    TEST_CHECK(rps.rmtLO.duration0 == 28 && rps.rmtLO.duration1 == 64);
+    destroy(&strip, &rps);
+
+    /* 500 us at divider 3 is 13333.3 ticks */
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, 10, 255) == ESP_OK);
+    TEST_CHECK(dled_strip_set_custom_timings(&strip, 300, 1090, 1090, 320, 500000) == ESP_OK);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_OK);
+    TEST_CHECK(rmt_dled_tick_ps(&rps) == 37500);
+    TEST_CHECK(rps.rmtLR.duration1 == 13334);
+    destroy(&strip, &rps);
+}
+
+static void test_frame_time(void)
+{
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    create(&strip, &rps, 10, 255);
+
+    /* WS2812B, 10 LEDs: 239 bits of 87 + 26 ticks, the last one 87 + 22400 ticks of 12.5 ns */
+    TEST_CHECK(rmt_dled_tick_ps(&rps) == 12500);
+    TEST_CHECK(rmt_dled_frame_time_ns(&rps) == 618675);
+
+    TEST_CHECK(rmt_dled_resize(&rps, 20) == ESP_OK);
+    TEST_CHECK(rmt_dled_frame_time_ns(&rps) == 618675 + 240 * 113 * 25 / 2);
+
+    destroy(&strip, &rps);
+    TEST_CHECK(rmt_dled_frame_time_ns(&rps) == 0);
+    TEST_CHECK(rmt_dled_frame_time_ns(NULL) == 0);
+    TEST_CHECK(rmt_dled_tick_ps(NULL) == 0);
+}
+
+static void test_resize_same_length(void)
+{
+    /* white and black: the last item is the 1 and the 0 with reset */
+    const uint8_t values[2] = { 255, 0 };
+    for (int i = 0; i < 2; i++) {
+        pixel_strip_t strip;
+        rmt_pixel_strip_t rps;
+        create(&strip, &rps, 10, values[i]);
+
+        uint32_t generation = strip.generation;
+        TEST_CHECK(rmt_dled_resize(&rps, 10) == ESP_OK);
+        TEST_CHECK(strip.generation == generation);
+        TEST_CHECK(same_as_full_encode(&rps));
+
+        /* shrink then grow back to the same length */
+        TEST_CHECK(rmt_dled_resize(&rps, 4) == ESP_OK);
+        TEST_CHECK(same_as_full_encode(&rps));
+        TEST_CHECK(rmt_dled_resize(&rps, 10) == ESP_OK);
+        TEST_CHECK(same_as_full_encode(&rps));
+
+        destroy(&strip, &rps);
+    }
+}
+
+static void test_encode_reset_twice(void)
+{
+    const uint8_t values[2] = { 255, 0 };
+    for (int i = 0; i < 2; i++) {
+        pixel_strip_t strip;
+        rmt_pixel_strip_t rps;
+        create(&strip, &rps, 10, values[i]);
+
+        rmt_dled_encode_reset(&rps);
+        rmt_dled_encode_reset(&rps);
+        TEST_CHECK(same_as_full_encode(&rps));
+
+        destroy(&strip, &rps);
+    }
+}
+
+static void test_reconfigure_pin(void)
+{
+    host_rmt_reset();
+
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    create(&strip, &rps, 10, 255);
+
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_18, RMT_CHANNEL_0) == ESP_OK);
+    TEST_CHECK(host_gpio_rmt_channel(GPIO_NUM_18) == RMT_CHANNEL_0);
+
+    /* same channel, other pin: the driver stays installed, the old pin is detached */
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_19, RMT_CHANNEL_0) == ESP_OK);
+    TEST_CHECK(host_gpio_rmt_channel(GPIO_NUM_19) == RMT_CHANNEL_0);
+    TEST_CHECK(host_gpio_rmt_channel(GPIO_NUM_18) == -1);
+    TEST_CHECK(host_rmt_installed(RMT_CHANNEL_0));
+
+    /* other channel and pin */
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_21, RMT_CHANNEL_1) == ESP_OK);
+    TEST_CHECK(host_gpio_rmt_channel(GPIO_NUM_21) == RMT_CHANNEL_1);
+    TEST_CHECK(host_gpio_rmt_channel(GPIO_NUM_19) == -1);
+    TEST_CHECK(!host_rmt_installed(RMT_CHANNEL_0));
+    TEST_CHECK(host_rmt_installed(RMT_CHANNEL_1));
+
+    /* other channel, same pin */
+    TEST_CHECK(rmt_dled_config(&rps, GPIO_NUM_21, RMT_CHANNEL_2) == ESP_OK);
+    TEST_CHECK(host_gpio_rmt_channel(GPIO_NUM_21) == RMT_CHANNEL_2);
+
+    TEST_CHECK(rmt_dled_send(&rps) == ESP_OK);
+    TEST_CHECK(host_rmt_write_count(RMT_CHANNEL_2) == 1);
+
+    destroy(&strip, &rps);
+}
+
+int main(void)
+{
+    host_rmt_reset();
+
+    test_select_divider();
+    test_reset_rounding();
+    test_frame_time();
+    test_resize_same_length();
+    test_encode_reset_twice();
+    test_reconfigure_pin();
+
+    return TEST_RESULT();
+}
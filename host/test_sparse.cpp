@@ -0,0 +1,140 @@
+/*
+ * rmt_dled_apply_updates: after any sequence of sparse updates, buffer writes and resizes,
+ * `ugly_buffer` equals a full rmt_dled_encode of `strip->buffer`.
+ */
+
+#include "esp32_rmt_dled.h"
+#include "dled_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t leds = 64;
+
+/* compares `ugly_buffer` with a full encoding, leaves the full encoding */
+static bool same_as_full_encode(rmt_pixel_strip_t *rps)
+{
+    uint32_t count = (uint32_t)rps->strip->buffer_length * 8;
+    rmt_item32_t *items = (rmt_item32_t*)malloc(count * sizeof(rmt_item32_t));
+    memcpy(items, rps->ugly_buffer, count * sizeof(rmt_item32_t));
+
+    rmt_dled_encode(rps);
+    bool same = (memcmp(items, rps->ugly_buffer, count * sizeof(rmt_item32_t)) == 0);
+    free(items);
+    return same;
+}
+
+/* `strip->buffer` holds `strip->pixels` in wire order, GRB */
+static bool buffer_matches_pixels(const pixel_strip_t *strip)
+{
+    for (uint16_t i = 0; i < strip->length; i++) {
+        const uint8_t *p = strip->buffer + (uint32_t)i * strip->bytes_per_led;
+        if (p[0] != strip->pixels[i].g || p[1] != strip->pixels[i].r || p[2] != strip->pixels[i].b) return false;
+    }
+    return true;
+}
+
+static pixel_update_t random_update(uint16_t length)
+{
+    pixel_update_t update;
+    update.index = (uint16_t)(rand() % length);
+    dled_pixel_set(&update.color, rand() & 0xff, rand() & 0xff, rand() & 0xff);
+    return update;
+}
+
+static void test_random_updates(rmt_pixel_strip_t *rps)
+{
+    for (int round = 0; round < 1000; round++) {
+        /* mostly sparse batches, sometimes a full one */
+        pixel_update_t updates[40];
+        uint16_t count = (round % 10 == 0) ? 40 : 1 + rand() % 3;
+        for (uint16_t i = 0; i < count; i++) updates[i] = random_update(rps->strip->length);
+        /* the last pixel holds the reset item */
+        if (round % 7 == 0) updates[0].index = rps->strip->length - 1;
+
+        TEST_CHECK(rmt_dled_apply_updates(rps, updates, count) == ESP_OK);
+        TEST_CHECK(same_as_full_encode(rps));
+        TEST_CHECK(buffer_matches_pixels(rps->strip));
+    }
+}
+
+/* the buffer is written by another function between an encoding and a sparse update */
+static void test_stale_items(rmt_pixel_strip_t *rps)
+{
+    pixel_strip_t *strip = rps->strip;
+    pixel_update_t update = { 5, { 1, 2, 3 } };
+
+    /* send, edit, fill the buffer, then a sparse update */
+    TEST_CHECK(rmt_dled_encode(rps) == ESP_OK);
+    dled_pixel_rainbow_step(strip->pixels, strip->length, 255, 11);
+    dled_strip_fill_buffer(strip);
+    TEST_CHECK(rmt_dled_apply_updates(rps, &update, 1) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+
+    pixel_t pixels[leds];
+    dled_pixel_rainbow_step(pixels, strip->length, 255, 23);
+    dled_strip_fill_buffer_from_pixels(strip, pixels);
+    TEST_CHECK(rmt_dled_apply_updates(rps, &update, 1) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+
+    pixel_planes_t planes;
+    dled_planes_init(&planes);
+    TEST_CHECK(dled_planes_create(&planes, strip->length) == ESP_OK);
+    dled_planes_fill(&planes, 9, 99, 199);
+    dled_strip_fill_buffer_from_planes(strip, &planes);
+    TEST_CHECK(rmt_dled_apply_updates(rps, &update, 1) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+    dled_planes_destroy(&planes);
+
+    /* written directly, as dled_dmx_parse does */
+    memset(strip->buffer, 0x55, strip->buffer_length);
+    strip->generation++;
+    TEST_CHECK(rmt_dled_apply_updates(rps, &update, 1) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+}
+
+static void test_resize(rmt_pixel_strip_t *rps)
+{
+    dled_strip_fill_buffer(rps->strip);
+    TEST_CHECK(rmt_dled_encode(rps) == ESP_OK);
+    TEST_CHECK(rmt_dled_resize(rps, leds * 2) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+    test_random_updates(rps);
+
+    TEST_CHECK(rmt_dled_resize(rps, leds / 2) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+    test_random_updates(rps);
+
+    /* resized while the items were stale: the next sparse update encodes everything */
+    dled_strip_fill_buffer(rps->strip);
+    TEST_CHECK(rmt_dled_resize(rps, leds) == ESP_OK);
+    pixel_update_t update = { 0, { 7, 7, 7 } };
+    TEST_CHECK(rmt_dled_apply_updates(rps, &update, 1) == ESP_OK);
+    TEST_CHECK(same_as_full_encode(rps));
+}
+
+int main(void)
+{
+    srand(1);
+
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_strip_init(&strip);
+    rmt_dled_init(&rps);
+    TEST_CHECK(dled_strip_create(&strip, DLED_WS2812B, leds, 255) == ESP_OK);
+    TEST_CHECK(rmt_dled_create(&rps, &strip) == ESP_OK);
+
+    /* sparse updates start from a known buffer and its encoding */
+    dled_pixel_rainbow_step(strip.pixels, strip.length, 255, 3);
+    dled_strip_fill_buffer(&strip);
+    TEST_CHECK(rmt_dled_encode(&rps) == ESP_OK);
+    TEST_CHECK(buffer_matches_pixels(&strip));
+
+    test_random_updates(&rps);
+    test_stale_items(&rps);
+    test_resize(&rps);
+
+    free(rps.ugly_buffer);
+    dled_strip_destroy(&strip);
+    return TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+/*
+ * dled_wire_sim: every strip type, encoded with its own timings, passes its datasheet windows;
+ * wrong custom timings and corrupted items are reported.
+ */
+
+#include "dled_wire_sim.h"
+#include "esp32_rmt_dled.h"
+#include "dled_test.h"
+
+#include <stdlib.h>
+
+static const uint16_t leds = 30;
+
+typedef struct {
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_wire_sim_t sim;
+} chain_t;
+
+/* encodes a rainbow and feeds it to a simulator with the datasheet windows of `type` */
+static esp_err_t run(chain_t *chain, dstrip_type_t type, const uint16_t *custom, uint32_t custom_trs)
+{
+    dled_strip_init(&chain->strip);
+    rmt_dled_init(&chain->rps);
+    dled_wire_sim_init(&chain->sim);
+
+    TEST_CHECK(dled_strip_create(&chain->strip, type, leds, 255) == ESP_OK);
+    if (custom != NULL) {
+        TEST_CHECK(dled_strip_set_custom_timings(&chain->strip, custom[0], custom[1], custom[2], custom[3], custom_trs) == ESP_OK);
+    }
+    dled_pixel_rainbow_step(chain->strip.pixels, leds, 255, type);
+    dled_strip_fill_buffer(&chain->strip);
+    TEST_CHECK(rmt_dled_create(&chain->rps, &chain->strip) == ESP_OK);
+    TEST_CHECK(rmt_dled_encode(&chain->rps) == ESP_OK);
+
+    dled_wire_sim_config_t config;
+    esp_err_t ret_val = dled_wire_sim_config_from_datasheet(&config, &chain->strip, rmt_dled_tick_ps(&chain->rps));
+    if (ret_val != ESP_OK) return ret_val;
+    TEST_CHECK(dled_wire_sim_create(&chain->sim, &config, leds) == ESP_OK);
+
+    dled_wire_sim_feed(&chain->sim, chain->rps.ugly_buffer, (uint32_t)chain->strip.buffer_length * 8);
+    dled_wire_sim_end(&chain->sim);
+    return ESP_OK;
+}
+
+static bool latched_ok(const chain_t *chain)
+{
+    return dled_wire_sim_latched_equals(&chain->sim, chain->strip.buffer, chain->strip.buffer_length);
+}
+
+static void done(chain_t *chain)
+{
+    dled_wire_sim_destroy(&chain->sim);
+    free(chain->rps.ugly_buffer);
+    dled_strip_destroy(&chain->strip);
+}
+
+static void test_all_types(void)
+{
+    for (int type = DLED_WS2812; type <= DLED_WS281x_FAST; type++) {
+        chain_t chain;
+        TEST_CHECK(run(&chain, (dstrip_type_t)type, NULL, 0) == ESP_OK);
+        if (chain.sim.violations != 0 || !latched_ok(&chain))
+            fprintf(stderr, "  type %d: %u violations, flags 0x%x\n", type, chain.sim.violations, chain.sim.violation_flags);
+        TEST_CHECK(chain.sim.violations == 0);
+        TEST_CHECK(chain.sim.frames == 1);
+        TEST_CHECK(latched_ok(&chain));
+        done(&chain);
+    }
+
+    pixel_strip_t strip;
+    dled_wire_sim_config_t config;
+    dled_strip_init(&strip);
+    TEST_CHECK(dled_wire_sim_config_from_datasheet(&config, &strip, 12500) == ESP_ERR_INVALID_ARG);
+}
+
+static void test_wrong_timings(void)
+{
+    chain_t chain;
+
+    /* a 0 bit as long as a 1 bit: read as 1 by the LEDs */
+    const uint16_t long_t0h[4] = { 700, 600, 1090, 320 };
+    TEST_CHECK(run(&chain, DLED_WS2812B, long_t0h, 280000) == ESP_OK);
+    TEST_CHECK(!latched_ok(&chain));
+    done(&chain);
+
+    /* a 0 bit between the windows */
+    const uint16_t mid_t0h[4] = { 450, 900, 1090, 320 };
+    TEST_CHECK(run(&chain, DLED_WS2812B, mid_t0h, 280000) == ESP_OK);
+    TEST_CHECK((chain.sim.violation_flags & DLED_SIM_HIGH_INVALID) != 0);
+    done(&chain);
+
+    /* the 50 us reset of older LEDs is too short for WS2812B */
+    const uint16_t nominal[4] = { 300, 1090, 1090, 320 };
+    TEST_CHECK(run(&chain, DLED_WS2812B, nominal, 50000) == ESP_OK);
+    TEST_CHECK(chain.sim.frames == 1);
+    TEST_CHECK((chain.sim.violation_flags & (DLED_SIM_LOW_LONG | DLED_SIM_NO_RESET)) != 0);
+    done(&chain);
+
+    /* the same timings with the WS2812B reset pass */
+    TEST_CHECK(run(&chain, DLED_WS2812B, nominal, 280000) == ESP_OK);
+    TEST_CHECK(chain.sim.violations == 0);
+    TEST_CHECK(latched_ok(&chain));
+    done(&chain);
+}
+
+static void test_corrupted_item(void)
+{
+    chain_t chain;
+    TEST_CHECK(run(&chain, DLED_WS2812B, NULL, 0) == ESP_OK);
+
+    chain.rps.ugly_buffer[5].duration0 = 3;
+    dled_wire_sim_feed(&chain.sim, chain.rps.ugly_buffer, (uint32_t)chain.strip.buffer_length * 8);
+    TEST_CHECK(chain.sim.violations == 1);
+    TEST_CHECK(chain.sim.violation_flags == DLED_SIM_HIGH_INVALID);
+    TEST_CHECK(chain.sim.first_violation == (int32_t)chain.strip.buffer_length * 8 + 5);
+    done(&chain);
+}
+
+int main(void)
+{
+    test_all_types();
+    test_wrong_timings();
+    test_corrupted_item();
+    return TEST_RESULT();
+}
@@ -0,0 +1,59 @@
+/*
+ * Replays a dump written by dled_recorder_dump, for example copied from the serial console
+ * or from a file system of the ESP32:
+ *
+ *     host/build/tool_dled_replay dump.bin
+ *
+ * Exits with 0 if all frames are latched as recorded without timing violations,
+ * 1 if not and 2 if the dump cannot be read.
+ */
+
+#include "dled_replay.h"
+#include "dled_wire_sim.h"
+
+#include <stdio.h>
+#include <vector>
+
+static const char *violation_names[] = {
+    "high time invalid", "low time short", "low time long", "no reset", "partial LED", "bad level"
+};
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <dump file>\n", argv[0]);
+        return 2;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    std::vector<uint8_t> dump;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        dump.insert(dump.end(), chunk, chunk + n);
+    fclose(file);
+
+    dled_replay_result_t result;
+    esp_err_t ret_val = dled_replay(dump.data(), dump.size(), &result);
+    if (ret_val != ESP_OK) {
+        fprintf(stderr, "%s: replay failed (0x%x) after %u frames\n", argv[1], ret_val, result.frames);
+        return 2;
+    }
+
+    printf("frames:             %u\n", result.frames);
+    printf("mismatches:         %u\n", result.mismatches);
+    printf("timing violations:  %u\n", result.violations);
+    for (int i = 0; i < 6; i++) {
+        if (result.violation_flags & (1 << i)) printf("                    %s\n", violation_names[i]);
+    }
+    printf("first bad frame:    %d\n", result.first_bad_frame);
+    printf("max wire time:      %.1f us\n", result.max_wire_time_ps / 1e6);
+    printf("max frame interval: %lld us\n", (long long)result.max_interval_us);
+    printf("overruns:           %u\n", result.overruns);
+
+    return (result.mismatches == 0 && result.violations == 0) ? 0 : 1;
+}
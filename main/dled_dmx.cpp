@@ -0,0 +1,325 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_dmx.h"
+
+#include <string.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_dmx";
+
+/*
+ * E1.31 (ANSI E1.31-2016) offsets.
+ * Root layer, common to data and synchronization packets.
+ */
+#define E131_OFF_PREAMBLE        0
+#define E131_OFF_POSTAMBLE       2
+#define E131_OFF_ACN_ID          4
+#define E131_OFF_ROOT_VECTOR    18
+/* Framing layer of data packets */
+#define E131_OFF_FRAME_VECTOR   40
+#define E131_OFF_SYNC_ADDRESS  109
+#define E131_OFF_SEQUENCE      111
+#define E131_OFF_OPTIONS       112
+#define E131_OFF_UNIVERSE      113
+/* DMP layer of data packets */
+#define E131_OFF_DMP_VECTOR    117
+#define E131_OFF_DMP_TYPE      118
+#define E131_OFF_FIRST_ADDRESS 119
+#define E131_OFF_INCREMENT     121
+#define E131_OFF_VALUE_COUNT   123
+#define E131_OFF_START_CODE    125
+#define E131_OFF_DATA          126
+/* Framing layer of synchronization packets */
+#define E131_OFF_SYNC_VECTOR    40
+#define E131_OFF_SYNC_SEQUENCE  44
+#define E131_OFF_SYNC_UNIVERSE  45
+#define E131_SYNC_LENGTH        49
+
+#define E131_VECTOR_ROOT_DATA     0x00000004
+#define E131_VECTOR_ROOT_EXTENDED 0x00000008
+#define E131_VECTOR_DATA_PACKET   0x00000002
+#define E131_VECTOR_SYNC_PACKET   0x00000001
+#define E131_DMP_SET_PROPERTY     0x02
+#define E131_DMP_ADDRESS_TYPE     0xa1
+
+#define E131_OPT_PREVIEW    0x80
+#define E131_OPT_TERMINATED 0x40
+
+/* Art-Net 4 offsets */
+#define ARTNET_OFF_OPCODE    8
+#define ARTNET_OFF_SEQUENCE 12
+#define ARTNET_OFF_SUBUNI   14
+#define ARTNET_OFF_NET      15
+#define ARTNET_OFF_LENGTH   16
+#define ARTNET_OFF_DATA     18
+#define ARTNET_SYNC_LENGTH  14
+
+#define ARTNET_OP_DMX  0x5000
+#define ARTNET_OP_SYNC 0x5200
+
+static const uint8_t e131_acn_id[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+static const uint8_t artnet_id[8]    = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+
+static uint16_t get_u16_be(const uint8_t *data) { return ((uint16_t)data[0] << 8) | data[1]; }
+static uint16_t get_u16_le(const uint8_t *data) { return ((uint16_t)data[1] << 8) | data[0]; }
+static uint32_t get_u32_be(const uint8_t *data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+esp_err_t dled_dmx_init(dmx_receiver_t *rx, dmx_universe_map_t *maps, uint8_t map_count)
+{
+	if (rx == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (maps == NULL && map_count != 0) {
+		ESP_LOGE(LOG_TAG, "Maps are NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (map_count > DLED_DMX_MAX_MAPS) {
+		ESP_LOGE(LOG_TAG, "Too many maps");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    for (uint8_t i = 0; i < map_count; i++) {
+        if (maps[i].strip == NULL) {
+            ESP_LOGE(LOG_TAG, "Strip of map %d is NULL", i);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if ((uint32_t)maps[i].buffer_offset + maps[i].length > maps[i].strip->buffer_length) {
+            ESP_LOGE(LOG_TAG, "Map %d does not fit in its strip", i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        maps[i].last_sequence = 0;
+        maps[i].has_sequence = false;
+    }
+
+    rx->maps = maps;
+    rx->map_count = map_count;
+    rx->sync_universe = 0;
+    rx->artnet_sync = false;
+    rx->pending = 0;
+    rx->packets = 0;
+    rx->out_of_sequence = 0;
+    rx->invalid = 0;
+
+    return ESP_OK;
+}
+
+/*
+ * E1.31 section 6.7.2: a packet is out of sequence if the difference from the last one,
+ * as a signed 8 bit value, is in the (-20, 0] range. Art-Net uses zero to disable sequencing.
+ */
+static bool dled_dmx_accept_sequence(dmx_universe_map_t *map, uint8_t sequence, bool zero_disables)
+{
+    if (zero_disables && sequence == 0) return true;
+
+    if (map->has_sequence) {
+        int8_t diff = (int8_t)(sequence - map->last_sequence);
+        if (diff <= 0 && diff > -20) return false;
+    }
+
+    map->last_sequence = sequence;
+    map->has_sequence = true;
+    return true;
+}
+
+static esp_err_t dled_dmx_write_universe(dmx_receiver_t *rx, uint16_t universe, uint8_t sequence, bool zero_disables,
+                                         const uint8_t *payload, uint16_t channels, uint32_t *written)
+{
+    bool dropped = false;
+
+    *written = 0;
+    for (uint8_t i = 0; i < rx->map_count; i++) {
+        dmx_universe_map_t *map = &rx->maps[i];
+        if (map->universe != universe) continue;
+
+        if (!dled_dmx_accept_sequence(map, sequence, zero_disables)) {
+            dropped = true;
+            continue;
+        }
+
+        if (map->start_channel < channels) {
+            uint16_t cnt = channels - map->start_channel;
+            if (cnt > map->length) cnt = map->length;
+            memcpy(map->strip->buffer + map->buffer_offset, payload + map->start_channel, cnt);
+            map->strip->generation++;
+        }
+        *written |= 1UL << i;
+    }
+
+    if (dropped && *written == 0) {
+        rx->out_of_sequence++;
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t dled_dmx_invalid(dmx_receiver_t *rx)
+{
+    rx->invalid++;
+    return ESP_ERR_INVALID_RESPONSE;
+}
+
+static esp_err_t dled_dmx_parse_e131_data(dmx_receiver_t *rx, const uint8_t *data, uint16_t length, uint32_t *ready_maps)
+{
+    if (length < E131_OFF_DATA) return dled_dmx_invalid(rx);
+    if (get_u32_be(data + E131_OFF_FRAME_VECTOR) != E131_VECTOR_DATA_PACKET) return dled_dmx_invalid(rx);
+    if (data[E131_OFF_DMP_VECTOR] != E131_DMP_SET_PROPERTY) return dled_dmx_invalid(rx);
+    if (data[E131_OFF_DMP_TYPE] != E131_DMP_ADDRESS_TYPE) return dled_dmx_invalid(rx);
+    if (get_u16_be(data + E131_OFF_FIRST_ADDRESS) != 0) return dled_dmx_invalid(rx);
+    if (get_u16_be(data + E131_OFF_INCREMENT) != 1) return dled_dmx_invalid(rx);
+
+    uint16_t value_count = get_u16_be(data + E131_OFF_VALUE_COUNT);
+    if (value_count == 0 || value_count > DLED_DMX_UNIVERSE_SIZE + 1) return dled_dmx_invalid(rx);
+    if (length < E131_OFF_START_CODE + value_count) return dled_dmx_invalid(rx);
+
+    rx->packets++;
+
+    /* preview data is not for output, other start codes (like 0xDD per-channel priority) are not DMX data */
+    uint8_t options = data[E131_OFF_OPTIONS];
+    if ((options & (E131_OPT_PREVIEW | E131_OPT_TERMINATED)) != 0) return ESP_OK;
+    if (data[E131_OFF_START_CODE] != 0) return ESP_OK;
+
+    uint32_t written;
+    esp_err_t ret_val = dled_dmx_write_universe(rx,
+        get_u16_be(data + E131_OFF_UNIVERSE), data[E131_OFF_SEQUENCE], false,
+        data + E131_OFF_DATA, value_count - 1, &written);
+    if (ret_val != ESP_OK) return ret_val;
+
+    uint16_t sync_universe = get_u16_be(data + E131_OFF_SYNC_ADDRESS);
+    if (sync_universe == 0) {
+        /* not (or no longer) synchronized, release everything */
+        *ready_maps = rx->pending | written;
+        rx->pending = 0;
+        rx->sync_universe = 0;
+    }
+    else {
+        rx->pending |= written;
+        rx->sync_universe = sync_universe;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t dled_dmx_parse_e131_sync(dmx_receiver_t *rx, const uint8_t *data, uint16_t length, uint32_t *ready_maps)
+{
+    if (length < E131_SYNC_LENGTH) return dled_dmx_invalid(rx);
+    if (get_u32_be(data + E131_OFF_SYNC_VECTOR) != E131_VECTOR_SYNC_PACKET) return dled_dmx_invalid(rx);
+
+    rx->packets++;
+
+    if (rx->sync_universe == 0) return ESP_OK;
+    if (get_u16_be(data + E131_OFF_SYNC_UNIVERSE) != rx->sync_universe) return ESP_OK;
+
+    *ready_maps = rx->pending;
+    rx->pending = 0;
+
+    return ESP_OK;
+}
+
+static esp_err_t dled_dmx_parse_e131(dmx_receiver_t *rx, const uint8_t *data, uint16_t length, uint32_t *ready_maps)
+{
+    if (length < E131_SYNC_LENGTH) return dled_dmx_invalid(rx);
+    if (get_u16_be(data + E131_OFF_PREAMBLE) != 0x0010) return dled_dmx_invalid(rx);
+    if (get_u16_be(data + E131_OFF_POSTAMBLE) != 0x0000) return dled_dmx_invalid(rx);
+
+    switch (get_u32_be(data + E131_OFF_ROOT_VECTOR)) {
+        case E131_VECTOR_ROOT_DATA:
+            return dled_dmx_parse_e131_data(rx, data, length, ready_maps);
+        case E131_VECTOR_ROOT_EXTENDED:
+            return dled_dmx_parse_e131_sync(rx, data, length, ready_maps);
+        default:
+            return dled_dmx_invalid(rx);
+    }
+}
+
+static esp_err_t dled_dmx_parse_artnet(dmx_receiver_t *rx, const uint8_t *data, uint16_t length, uint32_t *ready_maps)
+{
+    if (length < ARTNET_SYNC_LENGTH) return dled_dmx_invalid(rx);
+
+    uint16_t opcode = get_u16_le(data + ARTNET_OFF_OPCODE);
+
+    if (opcode == ARTNET_OP_SYNC) {
+        rx->packets++;
+        *ready_maps = rx->pending;
+        rx->pending = 0;
+        rx->artnet_sync = true;
+        return ESP_OK;
+    }
+
+    if (opcode != ARTNET_OP_DMX) {
+        /* ArtPoll and the other packets are not handled here */
+        return ESP_OK;
+    }
+
+    if (length < ARTNET_OFF_DATA) return dled_dmx_invalid(rx);
+    uint16_t channels = get_u16_be(data + ARTNET_OFF_LENGTH);
+    if (channels == 0 || channels > DLED_DMX_UNIVERSE_SIZE) return dled_dmx_invalid(rx);
+    if (length < ARTNET_OFF_DATA + channels) return dled_dmx_invalid(rx);
+
+    rx->packets++;
+
+    /* Port-Address is 15 bits: Net (7 bits), Sub-Net (4 bits) and Universe (4 bits) */
+    uint16_t universe = ((uint16_t)(data[ARTNET_OFF_NET] & 0x7f) << 8) | data[ARTNET_OFF_SUBUNI];
+
+    uint32_t written;
+    esp_err_t ret_val = dled_dmx_write_universe(rx,
+        universe, data[ARTNET_OFF_SEQUENCE], true,
+        data + ARTNET_OFF_DATA, channels, &written);
+    if (ret_val != ESP_OK) return ret_val;
+
+    if (rx->artnet_sync) { rx->pending |= written; }
+    else                 { *ready_maps = written; }
+
+    return ESP_OK;
+}
+
+esp_err_t dled_dmx_parse(dmx_receiver_t *rx, const uint8_t *data, uint16_t length, uint32_t *ready_maps)
+{
+    uint32_t ready = 0;
+    esp_err_t ret_val;
+
+	if (rx == NULL || data == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (length >= sizeof(artnet_id) && memcmp(data, artnet_id, sizeof(artnet_id)) == 0) {
+        ret_val = dled_dmx_parse_artnet(rx, data, length, &ready);
+    }
+    else if (length >= E131_OFF_ACN_ID + sizeof(e131_acn_id) &&
+             memcmp(data + E131_OFF_ACN_ID, e131_acn_id, sizeof(e131_acn_id)) == 0) {
+        ret_val = dled_dmx_parse_e131(rx, data, length, &ready);
+    }
+    else {
+        ret_val = dled_dmx_invalid(rx);
+    }
+
+    if (ready_maps != NULL) { *ready_maps = ready; }
+
+    return ret_val;
+}
+
+esp_err_t dled_dmx_reset_sync(dmx_receiver_t *rx, uint32_t *ready_maps)
+{
+	if (rx == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (ready_maps != NULL) { *ready_maps = rx->pending; }
+
+    rx->pending = 0;
+    rx->sync_universe = 0;
+    rx->artnet_sync = false;
+
+    return ESP_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
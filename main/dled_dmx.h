@@ -0,0 +1,132 @@
+#ifndef MAIN_DLED_DMX_H_
+#define MAIN_DLED_DMX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dled_strip.h"
+
+#include "esp_err.h"
+
+/**
+ * @brief Maximum number of universe maps handled by a dmx_receiver_t.
+ *
+ * Ready strips are reported as a bitmask of maps so this is limited to 32.
+ */
+#define DLED_DMX_MAX_MAPS 32
+
+/**
+ * @brief Maximum number of channels in a DMX universe.
+ */
+#define DLED_DMX_UNIVERSE_SIZE 512
+
+/**
+ * @brief Maps a range of channels from one universe into a strip's output buffer.
+ *
+ * Channel data is copied unchanged in the strip's `buffer` so the console should be
+ * patched in the wire color order of the LEDs (GRB for WS281x).
+ * Several maps can target the same universe or the same strip.
+ */
+typedef struct {
+    pixel_strip_t *strip;     /*!< The strip whose `buffer` receives the data */
+    uint16_t universe;        /*!< The universe number, as sent by the console */
+    uint16_t start_channel;   /*!< First used channel of the universe, zero based */
+    uint16_t buffer_offset;   /*!< Offset, in bytes, in the strip's `buffer` */
+    uint16_t length;          /*!< Number of channels (bytes) to copy */
+
+    uint8_t  last_sequence;   /*!< Sequence number of the last accepted packet */
+    bool     has_sequence;    /*!< true if `last_sequence` is valid */
+} dmx_universe_map_t;
+
+/**
+ * @brief Receiver state for E1.31 (sACN) and Art-Net packets.
+ *
+ */
+typedef struct {
+    dmx_universe_map_t *maps; /*!< The universe maps, supplied by caller */
+    uint8_t  map_count;       /*!< Number of universe maps */
+
+    uint16_t sync_universe;   /*!< E1.31 synchronization universe, zero if not synchronized */
+    bool     artnet_sync;     /*!< true after an ArtSync packet was received */
+    uint32_t pending;         /*!< Maps written and waiting for a synchronization packet */
+
+    uint32_t packets;         /*!< Number of valid packets processed */
+    uint32_t out_of_sequence; /*!< Number of packets dropped because of their sequence number */
+    uint32_t invalid;         /*!< Number of packets dropped as malformed or unknown */
+} dmx_receiver_t;
+
+/**
+ * @brief Initialize a dmx_receiver_t structure.
+ *
+ * @param[in,out] rx        The structure to be initialized.
+ * @param[in]     maps      The universe maps. The caller keeps the ownership of this array.
+ * @param[in]     map_count Number of universe maps, max. DLED_DMX_MAX_MAPS.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rx` argument is NULL __OR__ `maps` is NULL and `map_count` is not zero
+ *    - ESP_ERR_INVALID_SIZE if `map_count` is greater than DLED_DMX_MAX_MAPS
+ *    - ESP_ERR_INVALID_SIZE if a map does not fit in its strip's `buffer`
+ */
+esp_err_t dled_dmx_init(dmx_receiver_t *rx, dmx_universe_map_t *maps, uint8_t map_count);
+
+/**
+ * @brief Parse an E1.31 or Art-Net packet
+ *
+ * The packet can come from any transport (UDP socket, captured file, ...).
+ * DMX data is copied directly from `data` to the `buffer` of mapped strips.
+ *
+ * When the source does not use synchronization, the maps written by a data packet are
+ * reported immediately. Otherwise data is accumulated and the maps are reported when
+ * the synchronization packet arrives.
+ *
+ * @attention: Do not call dled_strip_fill_buffer on strips fed from this function because it
+ * will overwrite the received data with the content of `pixels` !
+ *
+ * @param[in,out] rx         The structure to work with.
+ * @param[in]     data       The packet.
+ * @param[in]     length     Length of the packet, in bytes.
+ * @param[out]    ready_maps Bitmask of maps whose strips should be sent now, may be NULL.
+ *
+ * @return
+ *    - ESP_OK success, including packets for universes which are not mapped
+ *    - ESP_ERR_INVALID_ARG if the `rx` or `data` arguments are NULL
+ *    - ESP_ERR_INVALID_RESPONSE if the packet is malformed or of an unknown type
+ *    - ESP_ERR_INVALID_STATE if the packet was dropped because of its sequence number
+ *
+ * @code{c}
+ * uint32_t ready;
+ * if (dled_dmx_parse(&rx, packet, packet_length, &ready) == ESP_OK) {
+ *     for (uint8_t i = 0; i < rx.map_count; i++) {
+ *         if (ready & (1UL << i)) { ... // send the strip of map i, once per strip
+ *     }
+ * }
+ * @endcode
+ */
+esp_err_t dled_dmx_parse(dmx_receiver_t *rx, const uint8_t *data, uint16_t length, uint32_t *ready_maps);
+
+/**
+ * @brief Leave the synchronized mode
+ *
+ * Call this when synchronization packets stopped arriving (E1.31 and Art-Net use
+ * a timeout of a few seconds). Pending maps are reported and data packets are
+ * reported immediately until a new synchronization packet arrives.
+ *
+ * @param[in,out] rx         The structure to work with.
+ * @param[out]    ready_maps Bitmask of maps written since the last synchronization, may be NULL.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rx` argument is NULL
+ */
+esp_err_t dled_dmx_reset_sync(dmx_receiver_t *rx, uint32_t *ready_maps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_encode_pool.h"
+
+#include <stdlib.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_encode_pool";
+
+esp_err_t dled_encode_pool_init(dled_encode_pool_t *pool)
+{
+    if (pool == NULL) { return ESP_ERR_INVALID_ARG; }
+
+    pool->worker_count = 0;
+    pool->chunk_bytes = 0;
+
+    pool->jobs = NULL;
+    pool->max_jobs = 0;
+    pool->job_count = 0;
+    pool->next_job = 0;
+
+    pool->start = NULL;
+    pool->done = NULL;
+    pool->running = false;
+
+    return ESP_OK;
+}
+
+static void dled_encode_pool_run_jobs(dled_encode_pool_t *pool)
+{
+    while (true) {
+        uint16_t idx = __atomic_fetch_add(&pool->next_job, 1, __ATOMIC_RELAXED);
+        if (idx >= pool->job_count) break;
+
+        dled_encode_job_t *job = &pool->jobs[idx];
+        rmt_dled_encode_range(job->rps, job->first, job->count);
+    }
+}
+
+static void dled_encode_pool_worker(void *arg)
+{
+    dled_encode_pool_t *pool = (dled_encode_pool_t*)arg;
+
+    while (true) {
+        dled_port_sem_take(pool->start);
+        if (!pool->running) break;
+
+        dled_encode_pool_run_jobs(pool);
+        dled_port_sem_give(pool->done);
+    }
+
+    dled_port_sem_give(pool->done);
+    dled_port_task_exit();
+}
+
+esp_err_t dled_encode_pool_create(dled_encode_pool_t *pool, uint8_t worker_count, uint16_t max_jobs,
+                                  uint16_t chunk_bytes, uint8_t priority)
+{
+	if (pool == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (max_jobs == 0) {
+		ESP_LOGE(LOG_TAG, "Number of jobs is 0");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    dled_encode_pool_init(pool);
+
+    pool->jobs = (dled_encode_job_t*)malloc(max_jobs * sizeof(dled_encode_job_t));
+    if (pool->jobs == NULL) {
+		ESP_LOGE(LOG_TAG, "Failed to allocate memory for jobs");
+		return ESP_ERR_NO_MEM;
+    }
+    pool->max_jobs = max_jobs;
+    pool->chunk_bytes = chunk_bytes;
+
+    if (dled_port_sem_create(&pool->start) != ESP_OK || dled_port_sem_create(&pool->done) != ESP_OK) {
+        dled_encode_pool_destroy(pool);
+		ESP_LOGE(LOG_TAG, "Failed to create semaphores");
+		return ESP_ERR_NO_MEM;
+    }
+
+    pool->running = true;
+    for (uint8_t i = 0; i < worker_count; i++) {
+        if (dled_port_task_create(dled_encode_pool_worker, "dled_encoder", pool, priority, -1) != ESP_OK) {
+            dled_encode_pool_destroy(pool);
+            ESP_LOGE(LOG_TAG, "Failed to create worker %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+        pool->worker_count++;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dled_encode_pool_destroy(dled_encode_pool_t *pool)
+{
+	if (pool == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    pool->running = false;
+    for (uint8_t i = 0; i < pool->worker_count; i++)
+        dled_port_sem_give(pool->start);
+    for (uint8_t i = 0; i < pool->worker_count; i++)
+        dled_port_sem_take(pool->done);
+
+    if (pool->start != NULL) { dled_port_sem_delete(pool->start); }
+    if (pool->done != NULL)  { dled_port_sem_delete(pool->done); }
+    if (pool->jobs != NULL)  { free(pool->jobs); }
+
+    dled_encode_pool_init(pool);
+
+    return ESP_OK;
+}
+
+esp_err_t dled_encode_pool_encode_all(dled_encode_pool_t *pool, rmt_pixel_strip_t **rps, uint8_t count)
+{
+	if (pool == NULL || rps == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    uint16_t job_count = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        rmt_pixel_strip_t *r = rps[i];
+        if (r == NULL || r->ugly_buffer == NULL || r->strip == NULL || r->strip->buffer == NULL) {
+            ESP_LOGE(LOG_TAG, "Strip %d or its buffers are NULL", i);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (r->strip->buffer_length == 0) {
+            ESP_LOGE(LOG_TAG, "Buffer length of strip %d is 0", i);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        uint16_t chunk = (pool->chunk_bytes == 0) ? r->strip->buffer_length : pool->chunk_bytes;
+        for (uint32_t first = 0; first < r->strip->buffer_length; first += chunk) {
+            if (job_count >= pool->max_jobs) {
+                ESP_LOGE(LOG_TAG, "Too many jobs");
+                return ESP_ERR_INVALID_SIZE;
+            }
+            uint32_t cnt = r->strip->buffer_length - first;
+            if (cnt > chunk) cnt = chunk;
+
+            pool->jobs[job_count].rps = r;
+            pool->jobs[job_count].first = (uint16_t)first;
+            pool->jobs[job_count].count = (uint16_t)cnt;
+            job_count++;
+        }
+    }
+
+    pool->job_count = job_count;
+    pool->next_job = 0;
+
+    /* the semaphores publish the jobs to the workers and the results back */
+    for (uint8_t i = 0; i < pool->worker_count; i++)
+        dled_port_sem_give(pool->start);
+
+    dled_encode_pool_run_jobs(pool);
+
+    for (uint8_t i = 0; i < pool->worker_count; i++)
+        dled_port_sem_take(pool->done);
+
+    for (uint8_t i = 0; i < count; i++)
+        rmt_dled_encode_reset(rps[i]);
+
+    return ESP_OK;
+}
+
+esp_err_t dled_encode_pool_send_all(dled_encode_pool_t *pool, rmt_pixel_strip_t **rps, uint8_t count)
+{
+    esp_err_t ret_val = dled_encode_pool_encode_all(pool, rps, count);
+    if (ret_val != ESP_OK) return ret_val;
+
+    /* start all transmissions, then wait for all */
+    uint8_t started = 0;
+    for (; started < count; started++) {
+        ret_val = rmt_dled_write(rps[started], false);
+        if (ret_val != ESP_OK) break;
+    }
+    for (uint8_t i = 0; i < started; i++)
+        rmt_dled_wait_tx_done(rps[i]);
+
+    return ret_val;
+}
+
+#ifdef __cplusplus
+}
+#endif
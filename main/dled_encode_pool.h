@@ -0,0 +1,135 @@
+#ifndef MAIN_DLED_ENCODE_POOL_H_
+#define MAIN_DLED_ENCODE_POOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dled_port.h"
+#include "esp32_rmt_dled.h"
+
+/**
+ * @brief A range of a strip's output buffer to be encoded.
+ *
+ */
+typedef struct {
+    rmt_pixel_strip_t *rps; /*!< The strip */
+    uint16_t first;         /*!< First byte of `strip->buffer` */
+    uint16_t count;         /*!< Number of bytes */
+} dled_encode_job_t;
+
+/**
+ * @brief Pool of worker tasks which encode the RMT items of several strips in parallel.
+ *
+ * Each strip is split in jobs of at most `chunk_bytes` bytes. The jobs are taken by the
+ * workers and by the calling task from a shared counter, so a very long strip is also
+ * encoded in parallel.
+ */
+typedef struct {
+    uint8_t worker_count;     /*!< Number of worker tasks */
+    uint16_t chunk_bytes;     /*!< Maximum number of bytes of a job */
+
+    dled_encode_job_t *jobs;  /*!< The jobs of the current batch */
+    uint16_t max_jobs;        /*!< Size of `jobs` */
+    uint16_t job_count;       /*!< Number of jobs of the current batch */
+    uint16_t next_job;        /*!< Index of the next job to be taken */
+
+    dled_port_sem_t start;    /*!< Given once per worker to start a batch */
+    dled_port_sem_t done;     /*!< Given by each worker at the end of a batch */
+    volatile bool running;    /*!< Cleared by dled_encode_pool_destroy */
+} dled_encode_pool_t;
+
+/**
+ * @brief Initialize a dled_encode_pool_t structure.
+ *
+ * @param[in,out] pool The structure to be initialized.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pool` argument is NULL
+ */
+esp_err_t dled_encode_pool_init(dled_encode_pool_t *pool);
+
+/**
+ * @brief Creates the worker tasks.
+ *
+ * The calling task also encodes so, for the two cores of ESP32, one worker is enough.
+ *
+ * @param[in,out] pool         The structure to work with.
+ * @param[in]     worker_count Number of worker tasks, zero to encode only in the calling task.
+ * @param[in]     max_jobs     Maximum number of jobs of a batch.
+ * @param[in]     chunk_bytes  Maximum number of bytes of a job, zero for one job per strip.
+ * @param[in]     priority     Priority of the worker tasks.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pool` argument is NULL
+ *    - ESP_ERR_INVALID_SIZE if `max_jobs` is zero
+ *    - ESP_ERR_NO_MEM if failed to allocate memory or to create the tasks
+ */
+esp_err_t dled_encode_pool_create(dled_encode_pool_t *pool, uint8_t worker_count, uint16_t max_jobs,
+                                  uint16_t chunk_bytes, uint8_t priority);
+
+/**
+ * @brief Stops the worker tasks and frees the memory.
+ *
+ * Calls `dled_encode_pool_init` to initialize the structure.
+ *
+ * @param[in,out] pool The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pool` argument is NULL
+ */
+esp_err_t dled_encode_pool_destroy(dled_encode_pool_t *pool);
+
+/**
+ * @brief Encode the RMT items of several strips
+ *
+ * Does the work of rmt_dled_encode for all strips, spread over the worker tasks.
+ * Must be called from one task at a time.
+ *
+ * @param[in,out] pool  The structure to work with.
+ * @param[in,out] rps   The strips.
+ * @param[in]     count Number of strips.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pool` or `rps` argument is NULL
+ *    - ESP_ERR_INVALID_ARG if a strip or one of its buffers is NULL or its output buffer length is zero
+ *    - ESP_ERR_INVALID_SIZE if the strips need more than `max_jobs` jobs
+ */
+esp_err_t dled_encode_pool_encode_all(dled_encode_pool_t *pool, rmt_pixel_strip_t **rps, uint8_t count);
+
+/**
+ * @brief Encode and send several strips
+ *
+ * Encodes all strips with dled_encode_pool_encode_all then starts all the transmissions
+ * and waits for them to end.
+ *
+ * @param[in,out] pool  The structure to work with.
+ * @param[in,out] rps   The strips, each one on its own RMT channel.
+ * @param[in]     count Number of strips.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - the error codes of dled_encode_pool_encode_all
+ *    - the error codes returned by the RMT driver, if error
+ *
+ * @code{c}
+ * rmt_pixel_strip_t *strips[2] = { &rps_a, &rps_b };
+ * dled_strip_fill_buffer(rps_a.strip);
+ * dled_strip_fill_buffer(rps_b.strip);
+ * dled_encode_pool_send_all(&pool, strips, 2);
+ * @endcode
+ */
+esp_err_t dled_encode_pool_send_all(dled_encode_pool_t *pool, rmt_pixel_strip_t **rps, uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
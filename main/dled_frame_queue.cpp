@@ -0,0 +1,305 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_frame_queue.h"
+#include "dled_port.h"
+
+#include <stdlib.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_fq";
+
+/* GCC atomic builtins, available for both Xtensa and the host */
+#define FQ_LOAD(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define FQ_STORE(ptr, val)   __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define FQ_CAS(ptr, exp, val) \
+    __atomic_compare_exchange_n((ptr), (exp), (val), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+/* the waiting flag and the state it waits for are ordered by full fences on both sides */
+#define FQ_FENCE()           __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define FQ_EXCHANGE(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_SEQ_CST)
+
+esp_err_t dled_frame_queue_init(dled_frame_queue_t *queue)
+{
+    if (queue == NULL) { return ESP_ERR_INVALID_ARG; }
+
+    queue->slots = NULL;
+    queue->slot_memory = NULL;
+    queue->slot_count = 0;
+    queue->capacity = 0;
+    queue->frame_size = 0;
+    queue->policy = DLED_FQ_DROP_OLDEST;
+
+    queue->ring = NULL;
+    queue->head = 0; queue->tail = 0;
+    queue->free_ring = NULL;
+    queue->free_head = 0; queue->free_tail = 0;
+
+    queue->producer_slot = -1;
+    queue->consumer_slot = -1;
+
+    queue->published = 0;
+    queue->overruns = 0;
+    queue->consumed = 0;
+    for (uint8_t i = 0; i < DLED_FQ_HISTOGRAM_SIZE; i++)
+        queue->latency_histogram[i] = 0;
+    queue->latency_max = 0;
+
+    queue->consumer_sem = NULL;
+    queue->producer_sem = NULL;
+    queue->consumer_waiting = false;
+    queue->producer_waiting = false;
+    queue->woken = false;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_frame_queue_create(dled_frame_queue_t *queue, uint16_t capacity, uint32_t frame_size, dled_fq_policy_t policy)
+{
+	if (queue == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (capacity == 0 || capacity > 0xfff0 || frame_size == 0) {
+		ESP_LOGE(LOG_TAG, "Invalid capacity or frame size");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    dled_frame_queue_init(queue);
+
+    uint16_t slot_count = capacity + 2;
+
+    queue->slots = (dled_frame_slot_t*)malloc(slot_count * sizeof(dled_frame_slot_t));
+    queue->slot_memory = (uint8_t*)malloc(slot_count * frame_size);
+    queue->ring = (uint16_t*)malloc(capacity * sizeof(uint16_t));
+    queue->free_ring = (uint16_t*)malloc(slot_count * sizeof(uint16_t));
+    if (queue->slots == NULL || queue->slot_memory == NULL || queue->ring == NULL || queue->free_ring == NULL) {
+        dled_frame_queue_destroy(queue);
+		ESP_LOGE(LOG_TAG, "Failed to allocate memory for frame queue");
+		return ESP_ERR_NO_MEM;
+    }
+    if (dled_port_sem_create(&queue->consumer_sem) != ESP_OK || dled_port_sem_create(&queue->producer_sem) != ESP_OK) {
+        dled_frame_queue_destroy(queue);
+		ESP_LOGE(LOG_TAG, "Failed to create the semaphores");
+		return ESP_ERR_NO_MEM;
+    }
+    else {
+        ESP_LOGI(LOG_TAG, "Allocated %d bytes for %d frames", slot_count * frame_size, slot_count);
+    }
+
+    queue->slot_count = slot_count;
+    queue->capacity = capacity;
+    queue->frame_size = frame_size;
+    queue->policy = policy;
+
+    for (uint16_t i = 0; i < slot_count; i++) {
+        queue->slots[i].data = queue->slot_memory + i * frame_size;
+        queue->slots[i].timestamp = 0;
+    }
+
+    /* slot 0 goes to the producer, the others are free */
+    queue->producer_slot = 0;
+    for (uint16_t i = 1; i < slot_count; i++)
+        queue->free_ring[i - 1] = i;
+    queue->free_head = slot_count - 1;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_frame_queue_destroy(dled_frame_queue_t *queue)
+{
+	if (queue == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (queue->slots != NULL)       { free(queue->slots); }
+    if (queue->slot_memory != NULL) { free(queue->slot_memory); }
+    if (queue->ring != NULL)        { free(queue->ring); }
+    if (queue->free_ring != NULL)   { free(queue->free_ring); }
+    if (queue->consumer_sem != NULL) { dled_port_sem_delete(queue->consumer_sem); }
+    if (queue->producer_sem != NULL) { dled_port_sem_delete(queue->producer_sem); }
+
+    dled_frame_queue_init(queue);
+
+    return ESP_OK;
+}
+
+/* condition a side waits for, rechecked after setting its waiting flag */
+typedef bool (*dled_fq_cond_fn_t)(dled_frame_queue_t *queue);
+
+static bool dled_frame_queue_not_full(dled_frame_queue_t *queue)
+{
+    return queue->head - FQ_LOAD(&queue->tail) < queue->capacity;
+}
+
+static bool dled_frame_queue_has_free(dled_frame_queue_t *queue)
+{
+    return queue->free_tail != FQ_LOAD(&queue->free_head);
+}
+
+static bool dled_frame_queue_ready(dled_frame_queue_t *queue)
+{
+    return FQ_LOAD(&queue->tail) != FQ_LOAD(&queue->head) || FQ_LOAD(&queue->woken);
+}
+
+/* sleeps once on `sem`, the caller checks `cond` again */
+static void dled_frame_queue_sleep(dled_frame_queue_t *queue, bool *waiting, dled_port_sem_t sem, dled_fq_cond_fn_t cond)
+{
+    FQ_STORE(waiting, true);
+    FQ_FENCE();
+    if (cond(queue)) {
+        /* if the flag was already cleared the other side gave the semaphore, consume it */
+        if (FQ_EXCHANGE(waiting, false)) return;
+    }
+    dled_port_sem_take(sem);
+}
+
+/* called after changing the state, wakes the other side if it is waiting */
+static void dled_frame_queue_notify(bool *waiting, dled_port_sem_t sem)
+{
+    FQ_FENCE();
+    if (FQ_EXCHANGE(waiting, false)) dled_port_sem_give(sem);
+}
+
+uint8_t* dled_frame_queue_producer_frame(dled_frame_queue_t *queue)
+{
+    if (queue == NULL)             return NULL;
+    if (queue->producer_slot < 0)  return NULL;
+
+    return queue->slots[queue->producer_slot].data;
+}
+
+esp_err_t dled_frame_queue_publish(dled_frame_queue_t *queue)
+{
+	if (queue == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (queue->producer_slot < 0) {
+		ESP_LOGE(LOG_TAG, "Queue not created");
+		return ESP_ERR_INVALID_STATE;
+	}
+
+    /* only the producer writes `head` */
+    uint32_t head = queue->head;
+    int32_t next_slot = -1;
+    bool waited = false;
+
+    while (true) {
+        uint32_t tail = FQ_LOAD(&queue->tail);
+        if (head - tail < queue->capacity) break;
+
+        if (queue->policy == DLED_FQ_BLOCK) {
+            if (!waited) { queue->overruns++; waited = true; }
+            dled_frame_queue_sleep(queue, &queue->producer_waiting, queue->producer_sem, dled_frame_queue_not_full);
+            continue;
+        }
+
+        /* full, take the oldest frame like the consumer does; if the consumer was faster retry */
+        uint16_t oldest = __atomic_load_n(&queue->ring[tail % queue->capacity], __ATOMIC_RELAXED);
+        if (FQ_CAS(&queue->tail, &tail, tail + 1)) {
+            next_slot = oldest;
+            queue->overruns++;
+            break;
+        }
+    }
+
+    queue->slots[queue->producer_slot].timestamp = dled_port_time_us();
+    __atomic_store_n(&queue->ring[head % queue->capacity], (uint16_t)queue->producer_slot, __ATOMIC_RELAXED);
+    FQ_STORE(&queue->head, head + 1);
+    queue->published++;
+    dled_frame_queue_notify(&queue->consumer_waiting, queue->consumer_sem);
+
+    if (next_slot < 0) {
+        /* there is always a free slot: producer 0, consumer max. 1 and max. `capacity` in ring */
+        uint32_t free_tail = queue->free_tail;
+        while (free_tail == FQ_LOAD(&queue->free_head)) {
+            dled_frame_queue_sleep(queue, &queue->producer_waiting, queue->producer_sem, dled_frame_queue_has_free);
+        }
+        next_slot = queue->free_ring[free_tail % queue->slot_count];
+        FQ_STORE(&queue->free_tail, free_tail + 1);
+    }
+    queue->producer_slot = next_slot;
+
+    return ESP_OK;
+}
+
+static void dled_frame_queue_record_latency(dled_frame_queue_t *queue, int64_t latency)
+{
+    uint8_t bucket = 0;
+
+    while (latency > 0 && bucket < DLED_FQ_HISTOGRAM_SIZE - 1) {
+        latency >>= 1;
+        bucket++;
+    }
+    queue->latency_histogram[bucket]++;
+}
+
+uint8_t* dled_frame_queue_acquire(dled_frame_queue_t *queue)
+{
+    if (queue == NULL)            return NULL;
+    if (queue->slot_count == 0)   return NULL;
+
+    dled_frame_queue_release(queue);
+
+    uint32_t tail = FQ_LOAD(&queue->tail);
+    uint16_t slot;
+    while (true) {
+        if (tail == FQ_LOAD(&queue->head)) return NULL;
+
+        slot = __atomic_load_n(&queue->ring[tail % queue->capacity], __ATOMIC_RELAXED);
+        /* on failure `tail` is updated with the current value */
+        if (FQ_CAS(&queue->tail, &tail, tail + 1)) break;
+    }
+
+    queue->consumer_slot = slot;
+    queue->consumed++;
+    if (queue->policy == DLED_FQ_BLOCK)
+        dled_frame_queue_notify(&queue->producer_waiting, queue->producer_sem);
+
+    int64_t latency = dled_port_time_us() - queue->slots[slot].timestamp;
+    if (latency > queue->latency_max) queue->latency_max = latency;
+    dled_frame_queue_record_latency(queue, latency);
+
+    return queue->slots[slot].data;
+}
+
+esp_err_t dled_frame_queue_release(dled_frame_queue_t *queue)
+{
+	if (queue == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (queue->consumer_slot < 0) return ESP_OK;
+
+    /* only the consumer writes `free_head` */
+    uint32_t free_head = queue->free_head;
+    queue->free_ring[free_head % queue->slot_count] = (uint16_t)queue->consumer_slot;
+    FQ_STORE(&queue->free_head, free_head + 1);
+    queue->consumer_slot = -1;
+    dled_frame_queue_notify(&queue->producer_waiting, queue->producer_sem);
+
+    return ESP_OK;
+}
+
+bool dled_frame_queue_wait(dled_frame_queue_t *queue)
+{
+    while (true) {
+        if (FQ_LOAD(&queue->tail) != FQ_LOAD(&queue->head)) return true;
+        if (FQ_EXCHANGE(&queue->woken, false)) return false;
+
+        dled_frame_queue_sleep(queue, &queue->consumer_waiting, queue->consumer_sem, dled_frame_queue_ready);
+    }
+}
+
+void dled_frame_queue_wakeup(dled_frame_queue_t *queue)
+{
+    FQ_STORE(&queue->woken, true);
+    dled_frame_queue_notify(&queue->consumer_waiting, queue->consumer_sem);
+}
+
+#ifdef __cplusplus
+}
+#endif
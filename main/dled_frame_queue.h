@@ -0,0 +1,216 @@
+#ifndef MAIN_DLED_FRAME_QUEUE_H_
+#define MAIN_DLED_FRAME_QUEUE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dled_port.h"
+
+#include "esp_err.h"
+
+/**
+ * @brief Number of buckets of the latency histogram.
+ *
+ * Bucket 0 counts latencies below 1 us, bucket `i` counts latencies in the
+ * [2^(i-1), 2^i) us range and the last bucket counts everything above.
+ */
+#define DLED_FQ_HISTOGRAM_SIZE 24
+
+/**
+ * @brief What the producer does when the queue is full.
+ *
+ */
+typedef enum {
+    DLED_FQ_DROP_OLDEST, /*!< The oldest frame not taken by the consumer is dropped */
+    DLED_FQ_BLOCK        /*!< The producer waits until the consumer takes a frame */
+} dled_fq_policy_t;
+
+/**
+ * @brief A frame slot.
+ *
+ */
+typedef struct {
+    uint8_t *data;     /*!< Frame data, `frame_size` bytes */
+    int64_t timestamp; /*!< Time of publishing, in microseconds */
+} dled_frame_slot_t;
+
+/**
+ * @brief Lock-free single producer / single consumer queue of frames.
+ *
+ * All the slots are allocated by dled_frame_queue_create. The producer and the consumer
+ * always own one slot each, the queue holds up to `capacity` published slots, so there are
+ * `capacity + 2` slots. Frames are never copied, only slot indexes are passed around.
+ *
+ * Published slot indexes are kept in `ring`. To drop the oldest frame the producer takes
+ * the slot at `tail` the same way the consumer does, by a compare-and-swap on `tail`.
+ * Slots released by the consumer are returned to the producer through `free_ring`.
+ *
+ * A side which has to wait sets its `waiting` flag, checks again and takes its semaphore.
+ * The other side gives the semaphore only when it clears a set flag, so the common path
+ * does not call the OS and a waiting task sleeps until it is notified.
+ */
+typedef struct {
+    dled_frame_slot_t *slots; /*!< The slots */
+    uint8_t  *slot_memory;    /*!< Memory of all slots' data */
+    uint16_t slot_count;      /*!< Number of slots, `capacity + 2` */
+    uint16_t capacity;        /*!< Maximum number of published frames */
+    uint32_t frame_size;      /*!< Size of a frame, in bytes */
+    dled_fq_policy_t policy;  /*!< Behavior when the queue is full */
+
+    uint16_t *ring;           /*!< Published slots, `capacity` entries */
+    uint32_t head, tail;      /*!< Write and read counters of `ring` */
+    uint16_t *free_ring;      /*!< Released slots, `slot_count` entries */
+    uint32_t free_head, free_tail; /*!< Write and read counters of `free_ring` */
+
+    int32_t  producer_slot;   /*!< Slot owned by the producer */
+    int32_t  consumer_slot;   /*!< Slot owned by the consumer, -1 if none */
+
+    uint32_t published;       /*!< Number of published frames, written by the producer */
+    uint32_t overruns;        /*!< Number of frames dropped (DLED_FQ_DROP_OLDEST) or of waits (DLED_FQ_BLOCK) */
+    uint32_t consumed;        /*!< Number of frames taken by the consumer */
+    uint32_t latency_histogram[DLED_FQ_HISTOGRAM_SIZE]; /*!< Publish to acquire latencies, written by the consumer */
+    int64_t  latency_max;     /*!< Maximum publish to acquire latency, in microseconds */
+
+    dled_port_sem_t consumer_sem; /*!< Given when a frame is published or by dled_frame_queue_wakeup */
+    dled_port_sem_t producer_sem; /*!< Given when the consumer takes or releases a frame */
+    bool consumer_waiting;    /*!< Set by the consumer before taking `consumer_sem` */
+    bool producer_waiting;    /*!< Set by the producer before taking `producer_sem` */
+    bool woken;               /*!< Set by dled_frame_queue_wakeup, cleared by dled_frame_queue_wait */
+} dled_frame_queue_t;
+
+/**
+ * @brief Initialize a dled_frame_queue_t structure.
+ *
+ * @param[in,out] queue The structure to be initialized.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `queue` argument is NULL
+ */
+esp_err_t dled_frame_queue_init(dled_frame_queue_t *queue);
+
+/**
+ * @brief Allocates the slots of a frame queue.
+ *
+ * This is the only function that allocates memory, publishing and consuming frames does not.
+ *
+ * @param[in,out] queue      The structure to work with.
+ * @param[in]     capacity   Maximum number of frames waiting in queue, min. 1.
+ * @param[in]     frame_size Size of a frame, in bytes. For wire data use `strip->buffer_length`.
+ * @param[in]     policy     Behavior when the queue is full.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `queue` argument is NULL
+ *    - ESP_ERR_INVALID_SIZE if `capacity` or `frame_size` is zero __OR__ `capacity` is too big
+ *    - ESP_ERR_NO_MEM if failed to allocate memory or to create the semaphores
+ */
+esp_err_t dled_frame_queue_create(dled_frame_queue_t *queue, uint16_t capacity, uint32_t frame_size, dled_fq_policy_t policy);
+
+/**
+ * @brief Frees the memory of a frame queue.
+ *
+ * Calls `dled_frame_queue_init` to initialize the structure.
+ * The producer and the consumer must be stopped before calling this function.
+ *
+ * @param[in,out] queue The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `queue` argument is NULL
+ */
+esp_err_t dled_frame_queue_destroy(dled_frame_queue_t *queue);
+
+/**
+ * @brief Producer: get the frame to be filled.
+ *
+ * The producer always owns a slot. The returned pointer changes after each dled_frame_queue_publish.
+ *
+ * @param[in] queue The structure to work with.
+ *
+ * @return Pointer to the frame data or NULL if `queue` is NULL or not created.
+ */
+uint8_t* dled_frame_queue_producer_frame(dled_frame_queue_t *queue);
+
+/**
+ * @brief Producer: publish the frame returned by dled_frame_queue_producer_frame.
+ *
+ * When the queue is full the oldest frame is dropped or the function waits, according to the policy.
+ * The producer sleeps until the consumer takes a frame, it does not poll.
+ *
+ * @param[in,out] queue The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `queue` argument is NULL
+ *    - ESP_ERR_INVALID_STATE if the queue is not created
+ */
+esp_err_t dled_frame_queue_publish(dled_frame_queue_t *queue);
+
+/**
+ * @brief Consumer: take the oldest published frame.
+ *
+ * The slot previously taken by the consumer, if any, is released first.
+ * The frame stays valid until the next call of dled_frame_queue_acquire or dled_frame_queue_release.
+ *
+ * @param[in,out] queue The structure to work with.
+ *
+ * @return Pointer to the frame data or NULL if the queue is empty.
+ *
+ * @code{c}
+ * // the output task
+ * while (running) {
+ *     uint8_t *frame = dled_frame_queue_acquire(&queue);
+ *     if (frame == NULL) { dled_frame_queue_wait(&queue); continue; }
+ *     memcpy(strip.buffer, frame, strip.buffer_length);
+ *     dled_frame_queue_release(&queue);
+ *     rmt_dled_send(&rps);
+ * }
+ * @endcode
+ */
+uint8_t* dled_frame_queue_acquire(dled_frame_queue_t *queue);
+
+/**
+ * @brief Consumer: release the frame taken by dled_frame_queue_acquire.
+ *
+ * @param[in,out] queue The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success, including when the consumer did not own a frame
+ *    - ESP_ERR_INVALID_ARG if the `queue` argument is NULL
+ */
+esp_err_t dled_frame_queue_release(dled_frame_queue_t *queue);
+
+/**
+ * @brief Consumer: wait for a published frame.
+ *
+ * Sleeps until the queue is not empty or dled_frame_queue_wakeup is called.
+ * With DLED_FQ_DROP_OLDEST the producer may take the frame back before the consumer
+ * acquires it, so dled_frame_queue_acquire can still return NULL.
+ *
+ * @param[in,out] queue The structure to work with, it must be created.
+ *
+ * @return
+ *    - true if the queue is not empty
+ *    - false if woken by dled_frame_queue_wakeup
+ */
+bool dled_frame_queue_wait(dled_frame_queue_t *queue);
+
+/**
+ * @brief Wake the consumer up from dled_frame_queue_wait, e.g. to stop it.
+ *
+ * If the consumer is not waiting, its next dled_frame_queue_wait returns immediately.
+ *
+ * @param[in,out] queue The structure to work with, it must be created.
+ */
+void dled_frame_queue_wakeup(dled_frame_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,305 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_pipeline.h"
+#include "dled_port.h"
+
+#include <stdlib.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_pipeline";
+
+/* the flags order the tasks' last accesses to the pipeline with dled_pipeline_stop */
+#define PL_LOAD(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define PL_STORE(ptr, val)   __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define PL_COUNT(ptr)        __atomic_fetch_add((ptr), 1, __ATOMIC_RELAXED)
+
+esp_err_t dled_pipeline_init(dled_pipeline_t *pipeline)
+{
+    if (pipeline == NULL) { return ESP_ERR_INVALID_ARG; }
+
+    pipeline->output.encode = NULL;
+    pipeline->output.send = NULL;
+    pipeline->output.wait = NULL;
+    pipeline->output.stop = NULL;
+    pipeline->output.arg = NULL;
+    pipeline->length = 0;
+    pipeline->max_cc_val = 0;
+    dled_frame_queue_init(&pipeline->queue);
+
+    pipeline->rps = NULL;
+    pipeline->items[0] = NULL;
+    pipeline->items[1] = NULL;
+
+    pipeline->render = NULL;
+    pipeline->render_arg = NULL;
+    pipeline->frame_period_ms = 0;
+
+    pipeline->running = false;
+    pipeline->render_active = false;
+    pipeline->output_active = false;
+    pipeline->output_error = ESP_OK;
+
+    pipeline->frames_rendered = 0;
+    pipeline->frames_sent = 0;
+    pipeline->frames_failed = 0;
+
+    return ESP_OK;
+}
+
+/* the RMT output stage, `arg` is the pipeline */
+
+static esp_err_t dled_pipeline_rmt_encode(void *arg, const pixel_t *pixels, uint8_t buffer)
+{
+    dled_pipeline_t *pipeline = (dled_pipeline_t*)arg;
+    rmt_pixel_strip_t *rps = pipeline->rps;
+
+    dled_strip_fill_buffer_from_pixels(rps->strip, pixels);
+    rps->ugly_buffer = pipeline->items[buffer];
+    return rmt_dled_encode(rps);
+}
+
+static esp_err_t dled_pipeline_rmt_send(void *arg, uint8_t buffer)
+{
+    dled_pipeline_t *pipeline = (dled_pipeline_t*)arg;
+    rmt_pixel_strip_t *rps = pipeline->rps;
+
+    rps->ugly_buffer = pipeline->items[buffer];
+    return rmt_dled_write(rps, false);
+}
+
+static esp_err_t dled_pipeline_rmt_wait(void *arg)
+{
+    dled_pipeline_t *pipeline = (dled_pipeline_t*)arg;
+    return rmt_dled_wait_tx_done(pipeline->rps);
+}
+
+static void dled_pipeline_rmt_stop(void *arg)
+{
+    dled_pipeline_t *pipeline = (dled_pipeline_t*)arg;
+    rmt_pixel_strip_t *rps = pipeline->rps;
+
+    /* give back the buffer owned by rps, its content is not the encoding of `strip->buffer` */
+    rps->ugly_buffer = pipeline->items[0];
+    rps->encoded = false;
+}
+
+esp_err_t dled_pipeline_create_with_output(dled_pipeline_t *pipeline, const dled_output_t *output,
+                                           uint16_t length, uint8_t max_cc_val,
+                                           dled_render_fn_t render, void *render_arg,
+                                           uint16_t capacity, dled_fq_policy_t policy)
+{
+	if (pipeline == NULL || output == NULL || render == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (output->encode == NULL || output->send == NULL || output->wait == NULL) {
+		ESP_LOGE(LOG_TAG, "Output stage function is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    dled_pipeline_init(pipeline);
+
+    esp_err_t ret_val = dled_frame_queue_create(&pipeline->queue, capacity, length * sizeof(pixel_t), policy);
+    if (ret_val != ESP_OK) {
+    	ESP_LOGE(LOG_TAG, "[0x%x] dled_frame_queue_create failed", ret_val);
+    	return ret_val;
+    }
+
+    pipeline->output = *output;
+    pipeline->length = length;
+    pipeline->max_cc_val = max_cc_val;
+    pipeline->render = render;
+    pipeline->render_arg = render_arg;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_pipeline_create(dled_pipeline_t *pipeline, rmt_pixel_strip_t *rps,
+                               dled_render_fn_t render, void *render_arg,
+                               uint16_t capacity, dled_fq_policy_t policy)
+{
+	if (pipeline == NULL || rps == NULL || render == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rps->strip == NULL || rps->ugly_buffer == NULL) {
+		ESP_LOGE(LOG_TAG, "Strip not created");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    dled_output_t output;
+    output.encode = dled_pipeline_rmt_encode;
+    output.send = dled_pipeline_rmt_send;
+    output.wait = dled_pipeline_rmt_wait;
+    output.stop = dled_pipeline_rmt_stop;
+    output.arg = pipeline;
+
+    esp_err_t ret_val = dled_pipeline_create_with_output(pipeline, &output, rps->strip->length, rps->strip->max_cc_val,
+                                                         render, render_arg, capacity, policy);
+    if (ret_val != ESP_OK) return ret_val;
+
+    uint32_t req_length = rps->strip->buffer_length * 8 * sizeof(rmt_item32_t);
+    pipeline->items[1] = (rmt_item32_t*)malloc(req_length);
+	if (pipeline->items[1] == NULL) {
+        dled_frame_queue_destroy(&pipeline->queue);
+        dled_pipeline_init(pipeline);
+		ESP_LOGE(LOG_TAG, "Failed to allocate memory for RMT items");
+		return ESP_ERR_NO_MEM;
+	}
+    else {
+        ESP_LOGI(LOG_TAG, "Allocated %d bytes for RMT items", req_length);
+    }
+
+    pipeline->rps = rps;
+    pipeline->items[0] = rps->ugly_buffer;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_pipeline_destroy(dled_pipeline_t *pipeline)
+{
+	if (pipeline == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    dled_pipeline_stop(pipeline);
+
+    dled_frame_queue_destroy(&pipeline->queue);
+    if (pipeline->items[1] != NULL) { free(pipeline->items[1]); }
+
+    dled_pipeline_init(pipeline);
+
+    return ESP_OK;
+}
+
+static void dled_pipeline_render_task(void *arg)
+{
+    dled_pipeline_t *pipeline = (dled_pipeline_t*)arg;
+    uint32_t frame = 0;
+
+    while (PL_LOAD(&pipeline->running)) {
+        int64_t start = dled_port_time_us();
+
+        pixel_t *pixels = (pixel_t*)dled_frame_queue_producer_frame(&pipeline->queue);
+        pipeline->render(pixels, pipeline->length, pipeline->max_cc_val, frame++, pipeline->render_arg);
+        dled_frame_queue_publish(&pipeline->queue);
+        PL_COUNT(&pipeline->frames_rendered);
+
+        if (pipeline->frame_period_ms != 0) {
+            uint32_t elapsed_ms = (uint32_t)((dled_port_time_us() - start) / 1000);
+            if (elapsed_ms < pipeline->frame_period_ms)
+                dled_port_delay_ms(pipeline->frame_period_ms - elapsed_ms);
+        }
+    }
+
+    PL_STORE(&pipeline->render_active, false);
+    dled_port_task_exit();
+}
+
+static void dled_pipeline_output_task(void *arg)
+{
+    dled_pipeline_t *pipeline = (dled_pipeline_t*)arg;
+    dled_output_t *output = &pipeline->output;
+    bool tx_pending = false;
+    uint8_t idx = 0;
+    esp_err_t ret_val;
+
+    /* keep draining while the render task runs, it may wait for a free frame */
+    while (PL_LOAD(&pipeline->running) || PL_LOAD(&pipeline->render_active)) {
+        pixel_t *pixels = (pixel_t*)dled_frame_queue_acquire(&pipeline->queue);
+        if (pixels == NULL) {
+            /* sleeps until the render task publishes or dled_pipeline_stop wakes it up */
+            dled_frame_queue_wait(&pipeline->queue);
+            continue;
+        }
+
+        /* encode in the buffer which is not transmitted */
+        ret_val = output->encode(output->arg, pixels, idx);
+        dled_frame_queue_release(&pipeline->queue);
+        if (ret_val != ESP_OK) {
+            PL_STORE(&pipeline->output_error, ret_val);
+            PL_COUNT(&pipeline->frames_failed);
+            continue;
+        }
+
+        if (tx_pending) {
+            ret_val = output->wait(output->arg);
+            if (ret_val != ESP_OK) PL_STORE(&pipeline->output_error, ret_val);
+        }
+        ret_val = output->send(output->arg, idx);
+        tx_pending = (ret_val == ESP_OK);
+        if (ret_val != ESP_OK) {
+            PL_STORE(&pipeline->output_error, ret_val);
+            PL_COUNT(&pipeline->frames_failed);
+            continue;
+        }
+
+        idx ^= 1;
+        PL_COUNT(&pipeline->frames_sent);
+    }
+
+    if (tx_pending) { output->wait(output->arg); }
+    if (output->stop != NULL) { output->stop(output->arg); }
+
+    PL_STORE(&pipeline->output_active, false);
+    dled_port_task_exit();
+}
+
+esp_err_t dled_pipeline_start(dled_pipeline_t *pipeline, int8_t render_core, int8_t output_core, uint8_t priority)
+{
+	if (pipeline == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (pipeline->render == NULL || PL_LOAD(&pipeline->render_active) || PL_LOAD(&pipeline->output_active)) {
+		ESP_LOGE(LOG_TAG, "Pipeline not created or running");
+		return ESP_ERR_INVALID_STATE;
+	}
+
+    PL_STORE(&pipeline->running, true);
+    PL_STORE(&pipeline->output_error, ESP_OK);
+
+    PL_STORE(&pipeline->output_active, true);
+    esp_err_t ret_val = dled_port_task_create(dled_pipeline_output_task, "dled_output", pipeline, priority, output_core);
+    if (ret_val != ESP_OK) {
+        PL_STORE(&pipeline->output_active, false);
+        PL_STORE(&pipeline->running, false);
+		ESP_LOGE(LOG_TAG, "Failed to create the output task");
+    	return ret_val;
+    }
+
+    PL_STORE(&pipeline->render_active, true);
+    ret_val = dled_port_task_create(dled_pipeline_render_task, "dled_render", pipeline, priority, render_core);
+    if (ret_val != ESP_OK) {
+        PL_STORE(&pipeline->render_active, false);
+        dled_pipeline_stop(pipeline);
+		ESP_LOGE(LOG_TAG, "Failed to create the render task");
+    	return ret_val;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dled_pipeline_stop(dled_pipeline_t *pipeline)
+{
+	if (pipeline == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    PL_STORE(&pipeline->running, false);
+    while (PL_LOAD(&pipeline->render_active) || PL_LOAD(&pipeline->output_active)) {
+        /* the output task may be waiting for a frame the render task will not publish */
+        if (PL_LOAD(&pipeline->output_active)) dled_frame_queue_wakeup(&pipeline->queue);
+        dled_port_yield();
+    }
+
+    return ESP_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,204 @@
+#ifndef MAIN_DLED_PIPELINE_H_
+#define MAIN_DLED_PIPELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dled_frame_queue.h"
+#include "esp32_rmt_dled.h"
+
+/**
+ * @brief Function which renders a frame.
+ *
+ * @param[out] pixels     The pixels to be set.
+ * @param[in]  length     Number of pixels.
+ * @param[in]  max_cc_val The maximum value allowed for a color component.
+ * @param[in]  frame      Index of the frame, starts from zero.
+ * @param[in]  arg        The `render_arg` of the pipeline.
+ */
+typedef void (*dled_render_fn_t)(pixel_t *pixels, uint16_t length, uint8_t max_cc_val, uint32_t frame, void *arg);
+
+/**
+ * @brief Function of the output stage which converts a frame in one of the two output buffers.
+ *
+ * @param[in] arg    The `arg` of the output stage.
+ * @param[in] pixels The rendered pixels.
+ * @param[in] buffer The output buffer, 0 or 1. It is never the buffer being sent.
+ */
+typedef esp_err_t (*dled_output_encode_fn_t)(void *arg, const pixel_t *pixels, uint8_t buffer);
+
+/**
+ * @brief Function of the output stage which starts sending an output buffer, without waiting for the end.
+ */
+typedef esp_err_t (*dled_output_send_fn_t)(void *arg, uint8_t buffer);
+
+/**
+ * @brief Function of the output stage which waits for the end of the transmission started by the send function.
+ */
+typedef esp_err_t (*dled_output_wait_fn_t)(void *arg);
+
+/**
+ * @brief Function of the output stage called by the output task before it ends.
+ */
+typedef void (*dled_output_stop_fn_t)(void *arg);
+
+/**
+ * @brief The output stage of a pipeline, double buffered.
+ *
+ * For each frame the output task calls `encode` with the buffer which is not sent, waits for
+ * the previous transmission, then calls `send` with this buffer.
+ * dled_pipeline_create uses the RMT output stage, tests can use any sink.
+ */
+typedef struct {
+    dled_output_encode_fn_t encode; /*!< Converts a frame in an output buffer */
+    dled_output_send_fn_t   send;   /*!< Starts sending an output buffer */
+    dled_output_wait_fn_t   wait;   /*!< Waits for the end of the transmission */
+    dled_output_stop_fn_t   stop;   /*!< Called when the output task ends, may be NULL */
+    void *arg;                      /*!< Argument passed to the functions */
+} dled_output_t;
+
+/**
+ * @brief Two stage pipeline: rendering on one core, buffer fill, encoding and sending on the other.
+ *
+ * The render task writes pixels in the frames of `queue`. The output task passes each frame to
+ * the output stage. The RMT output stage fills `strip->buffer` from a frame, encodes it in one
+ * of the two RMT item buffers and starts the transmission, so the next frame is encoded while
+ * the previous one is still sent.
+ * `strip->pixels` is not used while the pipeline runs.
+ */
+typedef struct {
+    dled_output_t output;       /*!< The output stage */
+    uint16_t length;            /*!< Number of pixels of a frame */
+    uint8_t max_cc_val;         /*!< The maximum value allowed for a color component, passed to `render` */
+    dled_frame_queue_t queue;   /*!< Rendered frames, each of `length` pixels */
+
+    rmt_pixel_strip_t *rps;     /*!< The LED strip of the RMT output stage, NULL for other output stages */
+    rmt_item32_t *items[2];     /*!< RMT item buffers; items[0] is `rps->ugly_buffer`, items[1] is allocated */
+
+    dled_render_fn_t render;    /*!< The render function */
+    void *render_arg;           /*!< Argument passed to `render` */
+    uint32_t frame_period_ms;   /*!< Minimum time between rendered frames, zero to render as fast as possible */
+
+    /* shared by the tasks, accessed with __atomic builtins; read them with __atomic_load_n while running */
+    bool running;               /*!< Cleared by dled_pipeline_stop */
+    bool render_active;         /*!< true while the render task runs */
+    bool output_active;         /*!< true while the output task runs */
+    esp_err_t output_error;     /*!< Last error of the output task */
+
+    uint32_t frames_rendered;   /*!< Number of frames rendered */
+    uint32_t frames_sent;       /*!< Number of frames sent */
+    uint32_t frames_failed;     /*!< Number of frames the output stage failed to encode or send */
+} dled_pipeline_t;
+
+/**
+ * @brief Initialize a dled_pipeline_t structure.
+ *
+ * @param[in,out] pipeline The structure to be initialized.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pipeline` argument is NULL
+ */
+esp_err_t dled_pipeline_init(dled_pipeline_t *pipeline);
+
+/**
+ * @brief Allocates the buffers of a pipeline sending to a LED strip with the RMT peripheral.
+ *
+ * All memory is allocated here, the running pipeline does not allocate.
+ *
+ * @param[in,out] pipeline   The structure to work with.
+ * @param[in]     rps        The LED strip, rmt_dled_create must be called first.
+ * @param[in]     render     The render function.
+ * @param[in]     render_arg Argument passed to `render`.
+ * @param[in]     capacity   Maximum number of rendered frames waiting to be sent.
+ * @param[in]     policy     What the render task does when `capacity` frames are waiting.
+ *                           Use DLED_FQ_BLOCK to render at the output rate.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if `pipeline`, `rps`, `rps->strip`, `rps->ugly_buffer` or `render` are NULL
+ *    - the error codes of dled_frame_queue_create
+ *    - ESP_ERR_NO_MEM if failed to allocate memory for RMT items
+ */
+esp_err_t dled_pipeline_create(dled_pipeline_t *pipeline, rmt_pixel_strip_t *rps,
+                               dled_render_fn_t render, void *render_arg,
+                               uint16_t capacity, dled_fq_policy_t policy);
+
+/**
+ * @brief Allocates the buffers of a pipeline with a custom output stage.
+ *
+ * @param[in,out] pipeline   The structure to work with.
+ * @param[in]     output     The output stage, copied in the pipeline.
+ * @param[in]     length     Number of pixels of a frame.
+ * @param[in]     max_cc_val The maximum value allowed for a color component, passed to `render`.
+ * @param[in]     render     The render function.
+ * @param[in]     render_arg Argument passed to `render`.
+ * @param[in]     capacity   Maximum number of rendered frames waiting to be sent.
+ * @param[in]     policy     What the render task does when `capacity` frames are waiting.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if `pipeline`, `output`, one of the `encode`, `send` and `wait` functions or `render` are NULL
+ *    - the error codes of dled_frame_queue_create
+ */
+esp_err_t dled_pipeline_create_with_output(dled_pipeline_t *pipeline, const dled_output_t *output,
+                                           uint16_t length, uint8_t max_cc_val,
+                                           dled_render_fn_t render, void *render_arg,
+                                           uint16_t capacity, dled_fq_policy_t policy);
+
+/**
+ * @brief Frees the memory allocated by dled_pipeline_create or dled_pipeline_create_with_output.
+ *
+ * Stops the pipeline if running then calls `dled_pipeline_init` to initialize the structure.
+ *
+ * @param[in,out] pipeline The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pipeline` argument is NULL
+ */
+esp_err_t dled_pipeline_destroy(dled_pipeline_t *pipeline);
+
+/**
+ * @brief Starts the render and output tasks.
+ *
+ * @param[in,out] pipeline    The structure to work with.
+ * @param[in]     render_core The core of the render task.
+ * @param[in]     output_core The core of the output task.
+ * @param[in]     priority    The priority of both tasks.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pipeline` argument is NULL
+ *    - ESP_ERR_INVALID_STATE if the pipeline is not created or is already running
+ *    - ESP_ERR_NO_MEM if a task could not be created
+ *
+ * @code{c}
+ * dled_pipeline_init(&pipeline);
+ * dled_pipeline_create(&pipeline, &rps, render_rainbow, NULL, 2, DLED_FQ_BLOCK);
+ * pipeline.frame_period_ms = 20;
+ * dled_pipeline_start(&pipeline, 1, 0, 5);
+ * @endcode
+ */
+esp_err_t dled_pipeline_start(dled_pipeline_t *pipeline, int8_t render_core, int8_t output_core, uint8_t priority);
+
+/**
+ * @brief Stops the tasks and waits for them to end.
+ *
+ * @param[in,out] pipeline The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `pipeline` argument is NULL
+ */
+esp_err_t dled_pipeline_stop(dled_pipeline_t *pipeline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
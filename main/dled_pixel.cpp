@@ -99,6 +99,66 @@ void dled_pixel_move_pixel(pixel_t *pixels, uint16_t length, uint8_t max_cc_val,
     }
 }
 
+void dled_pixel_fill(pixel_t *pixels, uint16_t length, uint8_t r, uint8_t g, uint8_t b)
+{
+    if (pixels == NULL) return;
+
+    for (uint16_t i = 0; i < length; i++) {
+        dled_pixel_set(&pixels[i], r, g, b);
+    }
+}
+
+void dled_pixel_fade(pixel_t *pixels, uint16_t length, uint8_t amount)
+{
+    if (pixels == NULL) return;
+
+    for (uint16_t i = 0; i < length; i++) {
+        pixels[i].r = (pixels[i].r > amount) ? pixels[i].r - amount : 0;
+        pixels[i].g = (pixels[i].g > amount) ? pixels[i].g - amount : 0;
+        pixels[i].b = (pixels[i].b > amount) ? pixels[i].b - amount : 0;
+    }
+}
+
+void dled_pixel_scale(pixel_t *pixels, uint16_t length, uint8_t factor)
+{
+    if (pixels == NULL) return;
+
+    uint16_t mul = (uint16_t)factor + 1;
+    for (uint16_t i = 0; i < length; i++) {
+        pixels[i].r = (uint8_t)((pixels[i].r * mul) >> 8);
+        pixels[i].g = (uint8_t)((pixels[i].g * mul) >> 8);
+        pixels[i].b = (uint8_t)((pixels[i].b * mul) >> 8);
+    }
+}
+
+void dled_pixel_add(pixel_t *dst, const pixel_t *src, uint16_t length)
+{
+    if (dst == NULL || src == NULL) return;
+
+    for (uint16_t i = 0; i < length; i++) {
+        uint16_t r = dst[i].r + src[i].r;
+        uint16_t g = dst[i].g + src[i].g;
+        uint16_t b = dst[i].b + src[i].b;
+        dled_pixel_set(&dst[i], r > 255 ? 255 : r, g > 255 ? 255 : g, b > 255 ? 255 : b);
+    }
+}
+
+void dled_pixel_blur(pixel_t *pixels, uint16_t length)
+{
+    if (pixels == NULL) return;
+    if (length == 0)    return;
+
+    pixel_t prev = pixels[0];
+    for (uint16_t i = 0; i < length; i++) {
+        pixel_t cur = pixels[i];
+        pixel_t next = (i + 1 < length) ? pixels[i + 1] : cur;
+        pixels[i].r = (uint8_t)((prev.r + 2 * cur.r + next.r + 2) >> 2);
+        pixels[i].g = (uint8_t)((prev.g + 2 * cur.g + next.g + 2) >> 2);
+        pixels[i].b = (uint8_t)((prev.b + 2 * cur.b + next.b + 2) >> 2);
+        prev = cur;
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
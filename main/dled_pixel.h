@@ -94,6 +94,53 @@ void dled_pixel_rainbow_step(pixel_t *pixels, uint16_t length, uint8_t max_cc_va
  */
 void dled_pixel_move_pixel(pixel_t *pixels, uint16_t length, uint8_t max_cc_val, uint16_t step);
 
+/**
+ * @brief Set all pixels to the same color.
+ *
+ * This and the following effect kernels work on an array of pixel_t, see dled_pixel_planes.h
+ * for the same kernels on separate color planes.
+ *
+ * @param[in,out] pixels  The pixels to be set.
+ * @param[in]     length  Number of pixels.
+ * @param[in]     r, g, b The RGB color components.
+ */
+void dled_pixel_fill(pixel_t *pixels, uint16_t length, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief Fade the pixels toward off by subtracting `amount` from each component, saturated to zero.
+ *
+ * @param[in,out] pixels The pixels to be changed.
+ * @param[in]     length Number of pixels.
+ * @param[in]     amount Value subtracted from each color component.
+ */
+void dled_pixel_fade(pixel_t *pixels, uint16_t length, uint8_t amount);
+
+/**
+ * @brief Scale the brightness of the pixels, each component becomes `value * (factor + 1) / 256`.
+ *
+ * @param[in,out] pixels The pixels to be changed.
+ * @param[in]     length Number of pixels.
+ * @param[in]     factor Scale factor, 255 keeps the values and 127 halves them.
+ */
+void dled_pixel_scale(pixel_t *pixels, uint16_t length, uint8_t factor);
+
+/**
+ * @brief Add the `src` pixels to the `dst` pixels, saturated to 255.
+ *
+ * @param[in,out] dst    The pixels to be changed.
+ * @param[in]     src    The pixels to add.
+ * @param[in]     length Number of pixels of both arrays.
+ */
+void dled_pixel_add(pixel_t *dst, const pixel_t *src, uint16_t length);
+
+/**
+ * @brief Blur the pixels with a (1 2 1) / 4 kernel, the first and last pixels are repeated.
+ *
+ * @param[in,out] pixels The pixels to be changed.
+ * @param[in]     length Number of pixels.
+ */
+void dled_pixel_blur(pixel_t *pixels, uint16_t length);
+
 #ifdef __cplusplus
 }
 #endif
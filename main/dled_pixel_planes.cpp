@@ -0,0 +1,181 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_pixel_planes.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_pixel_planes";
+
+/* the high bit of each byte of a 32-bit word */
+static const uint32_t high_bits = 0x80808080;
+
+esp_err_t dled_planes_init(pixel_planes_t *planes)
+{
+    if (planes == NULL) { return ESP_ERR_INVALID_ARG; }
+
+    planes->r = NULL;
+    planes->g = NULL;
+    planes->b = NULL;
+    planes->length = 0;
+    planes->stride = 0;
+    planes->memory = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_planes_create(pixel_planes_t *planes, uint16_t length)
+{
+	if (planes == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (length == 0) {
+		ESP_LOGE(LOG_TAG, "Invalid size");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    dled_planes_init(planes);
+
+    uint32_t stride = ((uint32_t)length + 3) & ~3UL;
+    /* malloc memory is aligned and `stride` is a multiple of 4 so all planes are 4 byte aligned */
+    planes->memory = (uint8_t*)calloc(3 * stride, 1);
+	if (planes->memory == NULL) {
+		ESP_LOGE(LOG_TAG, "Failed to allocate memory for planes");
+		return ESP_ERR_NO_MEM;
+	}
+    else {
+        ESP_LOGI(LOG_TAG, "Allocated %d bytes for planes", 3 * stride);
+    }
+
+    planes->r = planes->memory;
+    planes->g = planes->memory + stride;
+    planes->b = planes->memory + 2 * stride;
+    planes->length = length;
+    planes->stride = (uint16_t)stride;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_planes_destroy(pixel_planes_t *planes)
+{
+	if (planes == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (planes->memory != NULL) { free(planes->memory); }
+
+    dled_planes_init(planes);
+
+    return ESP_OK;
+}
+
+/* memcpy keeps the word accesses legal, compilers turn it into a single load or store */
+static inline uint32_t dled_planes_load(const uint8_t *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static inline void dled_planes_store(uint8_t *p, uint32_t w)
+{
+    memcpy(p, &w, sizeof(w));
+}
+
+void dled_planes_fill(pixel_planes_t *planes, uint8_t r, uint8_t g, uint8_t b)
+{
+    if (planes == NULL || planes->memory == NULL) return;
+
+    memset(planes->r, r, planes->stride);
+    memset(planes->g, g, planes->stride);
+    memset(planes->b, b, planes->stride);
+}
+
+void dled_planes_fade(pixel_planes_t *planes, uint8_t amount)
+{
+    if (planes == NULL || planes->memory == NULL) return;
+    if (amount == 0) return;
+
+    /* the three planes are contiguous, so this is one loop over all components */
+    uint8_t *p = planes->memory;
+    uint32_t count = 3 * (uint32_t)planes->stride;
+    for (uint32_t i = 0; i < count; i++) {
+        p[i] = (p[i] > amount) ? p[i] - amount : 0;
+    }
+}
+
+void dled_planes_scale(pixel_planes_t *planes, uint8_t factor)
+{
+    if (planes == NULL || planes->memory == NULL) return;
+    if (factor == 255) return;
+
+    uint8_t *p = planes->memory;
+    uint32_t count = 3 * (uint32_t)planes->stride;
+    uint16_t mul = (uint16_t)factor + 1;
+
+    if ((mul & (mul - 1)) == 0) {
+        /* a power of two, shift four components at a time and clear the bits moved in from the next byte */
+        uint8_t shift = 0;
+        while ((256 >> shift) != mul) shift++;
+        uint32_t mask = (0xFFu >> shift) * 0x01010101u;
+        for (uint32_t i = 0; i < count; i += 4) {
+            dled_planes_store(p + i, (dled_planes_load(p + i) >> shift) & mask);
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        p[i] = (uint8_t)((p[i] * mul) >> 8);
+    }
+}
+
+void dled_planes_add(pixel_planes_t *dst, const pixel_planes_t *src)
+{
+    if (dst == NULL || dst->memory == NULL) return;
+    if (src == NULL || src->memory == NULL) return;
+    if (dst->length != src->length) return;
+
+    uint8_t *d = dst->memory;
+    const uint8_t *s = src->memory;
+    uint32_t count = 3 * (uint32_t)dst->stride;
+
+    for (uint32_t i = 0; i < count; i += 4) {
+        uint32_t x = dled_planes_load(d + i);
+        uint32_t y = dled_planes_load(s + i);
+        /* add the low 7 bits of each byte, then the high bits without carry */
+        uint32_t sum = ((x & ~high_bits) + (y & ~high_bits)) ^ ((x ^ y) & high_bits);
+        /* carry out of bit 7 of each byte */
+        uint32_t carry = ((x & y) | ((x | y) & ~sum)) & high_bits;
+        /* saturate: 0x80 >> 7 is 0x01 and 0x01 * 0xFF is 0xFF, without crossing bytes */
+        dled_planes_store(d + i, sum | ((carry >> 7) * 0xFFu));
+    }
+}
+
+static void dled_planes_blur_plane(uint8_t *p, uint16_t length)
+{
+    uint8_t prev = p[0];
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t cur = p[i];
+        uint8_t next = (i + 1 < length) ? p[i + 1] : cur;
+        p[i] = (uint8_t)((prev + 2 * cur + next + 2) >> 2);
+        prev = cur;
+    }
+}
+
+void dled_planes_blur(pixel_planes_t *planes)
+{
+    if (planes == NULL || planes->memory == NULL) return;
+
+    dled_planes_blur_plane(planes->r, planes->length);
+    dled_planes_blur_plane(planes->g, planes->length);
+    dled_planes_blur_plane(planes->b, planes->length);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,103 @@
+#ifndef MAIN_DLED_PIXEL_PLANES_H_
+#define MAIN_DLED_PIXEL_PLANES_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief Pixels stored as structure of arrays, one plane for each color component.
+ *
+ * Each plane is 4 byte aligned and its size is rounded up to a multiple of 4 so the
+ * kernels can work on 32-bit words, four components at a time. The padding bytes are
+ * processed too but never sent to LEDs.
+ */
+typedef struct {
+    uint8_t *r;         /*!< Red plane */
+    uint8_t *g;         /*!< Green plane */
+    uint8_t *b;         /*!< Blue plane */
+    uint16_t length;    /*!< Number of pixels */
+    uint16_t stride;    /*!< Size of a plane, `length` rounded up to a multiple of 4 */
+    uint8_t *memory;    /*!< Memory of all planes */
+} pixel_planes_t;
+
+/**
+ * @brief Initialize a pixel_planes_t structure.
+ *
+ * @param[in,out] planes The structure to be initialized.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `planes` argument is NULL
+ */
+esp_err_t dled_planes_init(pixel_planes_t *planes);
+
+/**
+ * @brief Creates the planes, all pixels are off.
+ *
+ * @param[in,out] planes The structure to work with.
+ * @param[in]     length Number of pixels.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `planes` argument is NULL
+ *    - ESP_ERR_INVALID_SIZE if length is zero
+ *    - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t dled_planes_create(pixel_planes_t *planes, uint16_t length);
+
+/**
+ * @brief Destroy the planes.
+ *
+ * Calls `dled_planes_init` to initialize the structure.
+ *
+ * @param[in,out] planes The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `planes` argument is NULL
+ */
+esp_err_t dled_planes_destroy(pixel_planes_t *planes);
+
+/**
+ * @brief Set all pixels to the same color.
+ */
+void dled_planes_fill(pixel_planes_t *planes, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief Fade all pixels toward off by subtracting `amount` from each component.
+ *
+ * Components are saturated to zero.
+ */
+void dled_planes_fade(pixel_planes_t *planes, uint8_t amount);
+
+/**
+ * @brief Scale the brightness of all pixels.
+ *
+ * Each component becomes `value * (factor + 1) / 256`, so 255 keeps the values and 127 halves them.
+ * When `factor + 1` is a power of two the components are shifted four at a time.
+ */
+void dled_planes_scale(pixel_planes_t *planes, uint8_t factor);
+
+/**
+ * @brief Add the pixels of `src` to the pixels of `dst`.
+ *
+ * Components are saturated to 255. Both must have the same length.
+ */
+void dled_planes_add(pixel_planes_t *dst, const pixel_planes_t *src);
+
+/**
+ * @brief Blur the pixels with a (1 2 1) / 4 kernel, the first and last pixels are repeated.
+ */
+void dled_planes_blur(pixel_planes_t *planes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_port.h"
+
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+int64_t dled_port_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+void dled_port_yield(void)
+{
+    vTaskDelay(1);
+}
+
+void dled_port_delay_ms(uint32_t ms)
+{
+    if (ms == 0) return;
+    vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+/* the pipeline tasks do not use the stack much, the RMT and log functions do */
+static const uint32_t dled_port_task_stack_size = 4096;
+
+esp_err_t dled_port_task_create(dled_port_task_fn_t task_fn, const char *name, void *arg, uint8_t priority, int8_t core)
+{
+    BaseType_t affinity = (core < 0) ? tskNO_AFFINITY : core;
+
+    if (xTaskCreatePinnedToCore(task_fn, name, dled_port_task_stack_size, arg, priority, NULL, affinity) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void dled_port_task_exit(void)
+{
+    vTaskDelete(NULL);
+}
+
+esp_err_t dled_port_sem_create(dled_port_sem_t *sem)
+{
+    SemaphoreHandle_t handle = xSemaphoreCreateCounting(0xffff, 0);
+    if (handle == NULL) return ESP_ERR_NO_MEM;
+
+    *sem = handle;
+    return ESP_OK;
+}
+
+void dled_port_sem_delete(dled_port_sem_t sem)
+{
+    vSemaphoreDelete((SemaphoreHandle_t)sem);
+}
+
+void dled_port_sem_give(dled_port_sem_t sem)
+{
+    xSemaphoreGive((SemaphoreHandle_t)sem);
+}
+
+void dled_port_sem_take(dled_port_sem_t sem)
+{
+    xSemaphoreTake((SemaphoreHandle_t)sem, portMAX_DELAY);
+}
+
+#else
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+int64_t dled_port_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void dled_port_yield(void)
+{
+    sched_yield();
+}
+
+void dled_port_delay_ms(uint32_t ms)
+{
+    if (ms == 0) return;
+    usleep(ms * 1000);
+}
+
+typedef struct {
+    dled_port_task_fn_t task_fn;
+    void *arg;
+} dled_port_thread_arg_t;
+
+static void* dled_port_thread(void *arg)
+{
+    dled_port_thread_arg_t targ = *(dled_port_thread_arg_t*)arg;
+    free(arg);
+
+    targ.task_fn(targ.arg);
+    return NULL;
+}
+
+esp_err_t dled_port_task_create(dled_port_task_fn_t task_fn, const char *name, void *arg, uint8_t priority, int8_t core)
+{
+    (void)name; (void)priority; (void)core;
+
+    dled_port_thread_arg_t *targ = (dled_port_thread_arg_t*)malloc(sizeof(dled_port_thread_arg_t));
+    if (targ == NULL) return ESP_ERR_NO_MEM;
+    targ->task_fn = task_fn;
+    targ->arg = arg;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, dled_port_thread, targ) != 0) {
+        free(targ);
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_detach(thread);
+
+    return ESP_OK;
+}
+
+void dled_port_task_exit(void)
+{
+    pthread_exit(NULL);
+}
+
+esp_err_t dled_port_sem_create(dled_port_sem_t *sem)
+{
+    sem_t *handle = (sem_t*)malloc(sizeof(sem_t));
+    if (handle == NULL) return ESP_ERR_NO_MEM;
+    if (sem_init(handle, 0, 0) != 0) {
+        free(handle);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *sem = handle;
+    return ESP_OK;
+}
+
+void dled_port_sem_delete(dled_port_sem_t sem)
+{
+    sem_destroy((sem_t*)sem);
+    free(sem);
+}
+
+void dled_port_sem_give(dled_port_sem_t sem)
+{
+    sem_post((sem_t*)sem);
+}
+
+void dled_port_sem_take(dled_port_sem_t sem)
+{
+    while (sem_wait((sem_t*)sem) != 0) { }
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
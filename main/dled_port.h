@@ -0,0 +1,101 @@
+#ifndef MAIN_DLED_PORT_H_
+#define MAIN_DLED_PORT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/*
+ * The few OS services needed by the frame queue, the pipeline and the encoder pool.
+ * When built with ESP-IDF (ESP_PLATFORM is defined) these are mapped to esp_timer and FreeRTOS,
+ * otherwise to POSIX so the same code can be run and tested on a Linux host.
+ */
+
+/**
+ * @brief Get the time since boot (or since an unspecified moment on POSIX), in microseconds.
+ */
+int64_t dled_port_time_us(void);
+
+/**
+ * @brief Let other tasks run.
+ *
+ * Used by busy waiting loops. On ESP32 this is a one tick delay so lower priority
+ * tasks, like the idle task, are not starved.
+ */
+void dled_port_yield(void);
+
+/**
+ * @brief Wait for a number of milliseconds.
+ */
+void dled_port_delay_ms(uint32_t ms);
+
+/**
+ * @brief Type of the functions run by dled_port_task_create.
+ *
+ * The function must end by calling dled_port_task_exit.
+ */
+typedef void (*dled_port_task_fn_t)(void *arg);
+
+/**
+ * @brief Create a task.
+ *
+ * On ESP32 creates a FreeRTOS task pinned to `core`, on POSIX creates a detached thread
+ * and ignores `priority` and `core`.
+ *
+ * @param[in] task_fn  The function of the task.
+ * @param[in] name     Name of the task.
+ * @param[in] arg      The argument passed to `task_fn`.
+ * @param[in] priority Priority of the task.
+ * @param[in] core     The core to run on (0 or 1), -1 for any.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t dled_port_task_create(dled_port_task_fn_t task_fn, const char *name, void *arg, uint8_t priority, int8_t core);
+
+/**
+ * @brief Ends the calling task, must be the last call of a dled_port_task_fn_t.
+ */
+void dled_port_task_exit(void);
+
+/**
+ * @brief Counting semaphore, a FreeRTOS semaphore on ESP32 and a sem_t on POSIX.
+ */
+typedef void* dled_port_sem_t;
+
+/**
+ * @brief Create a counting semaphore with the initial count of zero.
+ *
+ * @param[out] sem The semaphore.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_NO_MEM if the semaphore could not be created
+ */
+esp_err_t dled_port_sem_create(dled_port_sem_t *sem);
+
+/**
+ * @brief Delete a semaphore created by dled_port_sem_create.
+ */
+void dled_port_sem_delete(dled_port_sem_t sem);
+
+/**
+ * @brief Increment the count of a semaphore.
+ */
+void dled_port_sem_give(dled_port_sem_t sem);
+
+/**
+ * @brief Wait for the count of a semaphore to be positive then decrement it.
+ */
+void dled_port_sem_take(dled_port_sem_t sem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
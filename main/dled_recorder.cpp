@@ -0,0 +1,211 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_recorder.h"
+#include "dled_port.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_recorder";
+
+esp_err_t dled_recorder_init(dled_recorder_t *rec)
+{
+    if (rec == NULL) { return ESP_ERR_INVALID_ARG; }
+
+    rec->strip = NULL;
+    rec->type = DLED_NULL;
+    rec->bytes_per_led = 0;
+    rec->T0H = 0; rec->T0L = 0; rec->T1H = 0; rec->T1L = 0;
+    rec->TRS = 0;
+    rec->frames = NULL;
+    rec->timestamps = NULL;
+    rec->lengths = NULL;
+    rec->frame_size = 0;
+    rec->capacity = 0;
+    rec->next = 0;
+    rec->recorded = 0;
+    rec->enabled = false;
+
+    return ESP_OK;
+}
+
+/* the frames in the ring were sent with the type and timings of `strip` */
+static void dled_recorder_set_timings(dled_recorder_t *rec, const pixel_strip_t *strip)
+{
+    rec->type = strip->type;
+    rec->bytes_per_led = strip->bytes_per_led;
+    rec->T0H = strip->T0H; rec->T0L = strip->T0L;
+    rec->T1H = strip->T1H; rec->T1L = strip->T1L;
+    rec->TRS = strip->TRS;
+}
+
+static bool dled_recorder_same_timings(const dled_recorder_t *rec, const pixel_strip_t *strip)
+{
+    return rec->type == strip->type && rec->bytes_per_led == strip->bytes_per_led &&
+           rec->T0H == strip->T0H && rec->T0L == strip->T0L &&
+           rec->T1H == strip->T1H && rec->T1L == strip->T1L && rec->TRS == strip->TRS;
+}
+
+esp_err_t dled_recorder_create(dled_recorder_t *rec, const pixel_strip_t *strip, uint16_t capacity)
+{
+	if (rec == NULL || strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    uint32_t frame_size = (uint32_t)strip->capacity * strip->bytes_per_led;
+	if (capacity == 0 || frame_size == 0) {
+		ESP_LOGE(LOG_TAG, "Invalid size");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    dled_recorder_init(rec);
+
+    uint32_t req_length = (uint32_t)capacity * frame_size;
+    rec->frames = (uint8_t*)malloc(req_length);
+    rec->timestamps = (int64_t*)malloc(capacity * sizeof(int64_t));
+    rec->lengths = (uint16_t*)malloc(capacity * sizeof(uint16_t));
+    if (rec->frames == NULL || rec->timestamps == NULL || rec->lengths == NULL) {
+        dled_recorder_destroy(rec);
+		ESP_LOGE(LOG_TAG, "Failed to allocate memory for frames");
+		return ESP_ERR_NO_MEM;
+    }
+    else {
+        ESP_LOGI(LOG_TAG, "Allocated %d bytes for frames", req_length);
+    }
+
+    rec->strip = strip;
+    dled_recorder_set_timings(rec, strip);
+    rec->frame_size = frame_size;
+    rec->capacity = capacity;
+    rec->enabled = true;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_recorder_destroy(dled_recorder_t *rec)
+{
+	if (rec == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (rec->frames != NULL)     { free(rec->frames); }
+    if (rec->timestamps != NULL) { free(rec->timestamps); }
+    if (rec->lengths != NULL)    { free(rec->lengths); }
+
+    dled_recorder_init(rec);
+
+    return ESP_OK;
+}
+
+void dled_recorder_capture(dled_recorder_t *rec, const uint8_t *buffer, uint16_t length)
+{
+    /* called for every frame sent, so no logging and only the cheap checks */
+    if (!rec->enabled || rec->frames == NULL) return;
+
+    /* older frames would be replayed with the new timings */
+    if (!dled_recorder_same_timings(rec, rec->strip)) {
+        rec->next = 0;
+        rec->recorded = 0;
+        dled_recorder_set_timings(rec, rec->strip);
+    }
+
+    if (length > rec->frame_size) length = rec->frame_size;
+
+    uint16_t idx = rec->next;
+    memcpy(rec->frames + (uint32_t)idx * rec->frame_size, buffer, length);
+    rec->timestamps[idx] = dled_port_time_us();
+    rec->lengths[idx] = length;
+
+    rec->next = (idx + 1 < rec->capacity) ? idx + 1 : 0;
+    rec->recorded++;
+}
+
+void dled_recorder_enable(dled_recorder_t *rec, bool enabled)
+{
+    if (rec == NULL) return;
+    rec->enabled = enabled;
+}
+
+void dled_recorder_clear(dled_recorder_t *rec)
+{
+    if (rec == NULL) return;
+    rec->next = 0;
+    rec->recorded = 0;
+}
+
+uint16_t dled_recorder_count(const dled_recorder_t *rec)
+{
+    if (rec == NULL) return 0;
+    return (rec->recorded < rec->capacity) ? (uint16_t)rec->recorded : rec->capacity;
+}
+
+static void dled_recorder_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void dled_recorder_put32(uint8_t *p, uint32_t v)
+{
+    dled_recorder_put16(p, (uint16_t)v);
+    dled_recorder_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+esp_err_t dled_recorder_dump(const dled_recorder_t *rec, dled_recorder_write_fn_t write, void *arg)
+{
+	if (rec == NULL || write == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rec->frames == NULL || rec->strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Recorder not created");
+		return ESP_ERR_INVALID_STATE;
+	}
+
+    uint16_t count = dled_recorder_count(rec);
+
+    uint8_t header[DLED_RECORDER_HEADER_SIZE];
+    memcpy(header, "DLRC", 4);
+    header[4] = DLED_RECORDER_VERSION;
+    header[5] = (uint8_t)rec->type;
+    header[6] = rec->bytes_per_led;
+    header[7] = 0;
+    dled_recorder_put16(header + 8,  rec->T0H);
+    dled_recorder_put16(header + 10, rec->T0L);
+    dled_recorder_put16(header + 12, rec->T1H);
+    dled_recorder_put16(header + 14, rec->T1L);
+    dled_recorder_put32(header + 16, rec->TRS);
+    dled_recorder_put32(header + 20, rec->frame_size);
+    dled_recorder_put32(header + 24, count);
+
+    esp_err_t ret_val = write(header, sizeof(header), arg);
+    if (ret_val != ESP_OK) return ret_val;
+
+    /* when the ring is full the oldest frame is the next to be overwritten */
+    uint16_t idx = (rec->recorded < rec->capacity) ? 0 : rec->next;
+    for (uint16_t i = 0; i < count; i++) {
+        uint8_t frame_header[DLED_RECORDER_FRAME_HEADER_SIZE];
+        uint64_t ts = (uint64_t)rec->timestamps[idx];
+        dled_recorder_put32(frame_header, (uint32_t)ts);
+        dled_recorder_put32(frame_header + 4, (uint32_t)(ts >> 32));
+        dled_recorder_put32(frame_header + 8, rec->lengths[idx]);
+
+        ret_val = write(frame_header, sizeof(frame_header), arg);
+        if (ret_val != ESP_OK) return ret_val;
+        ret_val = write(rec->frames + (uint32_t)idx * rec->frame_size, rec->lengths[idx], arg);
+        if (ret_val != ESP_OK) return ret_val;
+
+        idx = (idx + 1 < rec->capacity) ? idx + 1 : 0;
+    }
+
+    return ESP_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
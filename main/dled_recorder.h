@@ -0,0 +1,179 @@
+#ifndef MAIN_DLED_RECORDER_H_
+#define MAIN_DLED_RECORDER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dled_strip.h"
+
+#include "esp_err.h"
+
+/*
+ * The dump written by dled_recorder_dump, all values are little endian:
+ *
+ *    offset size
+ *     0      4   magic "DLRC"
+ *     4      1   version, DLED_RECORDER_VERSION
+ *     5      1   strip type of the frames, dstrip_type_t
+ *     6      1   bytes per LED
+ *     7      1   reserved, 0
+ *     8      8   T0H, T0L, T1H, T1L of the frames, 2 bytes each
+ *    16      4   TRS of the frames
+ *    20      4   frame size, the maximum length of a frame
+ *    24      4   number of frames
+ *    28          the frames, oldest first, each one:
+ *                8 bytes timestamp in us, 4 bytes length, `length` bytes of `strip->buffer`
+ */
+#define DLED_RECORDER_VERSION 1
+#define DLED_RECORDER_HEADER_SIZE 28
+#define DLED_RECORDER_FRAME_HEADER_SIZE 12
+
+/**
+ * @brief Ring of the last frames sent to a strip.
+ *
+ * Each capture is one memcpy of `strip->buffer`, the oldest frame is overwritten when the ring is full.
+ */
+typedef struct {
+    const pixel_strip_t *strip; /*!< The recorded strip */
+    dstrip_type_t type;         /*!< Strip type of the frames in the ring, written in the dump */
+    uint8_t  bytes_per_led;     /*!< Bytes per LED of the frames in the ring */
+    uint16_t T0H, T0L, T1H, T1L; /*!< Timings of the frames in the ring, written in the dump */
+    uint32_t TRS;               /*!< Reset timing of the frames in the ring */
+    uint8_t  *frames;           /*!< `capacity` frames of `frame_size` bytes */
+    int64_t  *timestamps;       /*!< Capture time of each frame, in us */
+    uint16_t *lengths;          /*!< Length of each frame */
+    uint32_t frame_size;        /*!< Maximum length of a frame, longer frames are truncated */
+    uint16_t capacity;          /*!< Number of frames of the ring */
+    uint16_t next;              /*!< Index of the frame written by the next capture */
+    uint32_t recorded;          /*!< Number of frames captured since create or clear */
+    volatile bool enabled;      /*!< Frames are captured only when true */
+} dled_recorder_t;
+
+/**
+ * @brief Type of the function called by dled_recorder_dump to output the data.
+ *
+ * @return ESP_OK on success, any other value stops the dump and is returned by dled_recorder_dump.
+ */
+typedef esp_err_t (*dled_recorder_write_fn_t)(const void *data, size_t length, void *arg);
+
+/**
+ * @brief Initialize a dled_recorder_t structure.
+ *
+ * @param[in,out] rec The structure to be initialized.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rec` argument is NULL
+ */
+esp_err_t dled_recorder_init(dled_recorder_t *rec);
+
+/**
+ * @brief Creates the ring of a recorder, the recorder is enabled.
+ *
+ * The frame size is the buffer size of `strip->capacity` LEDs so a strip resized
+ * within its capacity is recorded entirely.
+ *
+ * @param[in,out] rec      The structure to work with.
+ * @param[in]     strip    The strip to record.
+ * @param[in]     capacity Number of frames of the ring.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rec` or `strip` argument is NULL
+ *    - ESP_ERR_INVALID_SIZE if `capacity` or the strip's buffer size is zero
+ *    - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t dled_recorder_create(dled_recorder_t *rec, const pixel_strip_t *strip, uint16_t capacity);
+
+/**
+ * @brief Destroy the ring of a recorder.
+ *
+ * Calls `dled_recorder_init` to initialize the structure.
+ *
+ * @param[in,out] rec The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rec` argument is NULL
+ */
+esp_err_t dled_recorder_destroy(dled_recorder_t *rec);
+
+/**
+ * @brief Capture a frame
+ *
+ * Called by rmt_dled_write when CONFIG_DLED_RECORDER is enabled and `rps->recorder` is set.
+ * Does nothing if the recorder is disabled.
+ *
+ * A dump has one set of timings, so the ring is cleared when the type or the timings
+ * of the strip differ from those of the frames in the ring. Frames keep their own length.
+ *
+ * @param[in,out] rec    The structure to work with.
+ * @param[in]     buffer The frame, wire order (as in `strip->buffer`).
+ * @param[in]     length Length of `buffer`.
+ */
+void dled_recorder_capture(dled_recorder_t *rec, const uint8_t *buffer, uint16_t length);
+
+/**
+ * @brief Enable or disable the capture of frames
+ *
+ * Disable the recorder before dumping it, or the frames may change while written.
+ *
+ * @param[in,out] rec     The structure to work with.
+ * @param[in]     enabled true to capture frames.
+ */
+void dled_recorder_enable(dled_recorder_t *rec, bool enabled);
+
+/**
+ * @brief Forget all captured frames
+ *
+ * @param[in,out] rec The structure to work with.
+ */
+void dled_recorder_clear(dled_recorder_t *rec);
+
+/**
+ * @brief Get the number of frames in the ring
+ *
+ * @param[in] rec The structure to work with.
+ *
+ * @return The number of frames which would be dumped.
+ */
+uint16_t dled_recorder_count(const dled_recorder_t *rec);
+
+/**
+ * @brief Write the captured frames
+ *
+ * The frames are not removed from the ring.
+ *
+ * @param[in] rec   The structure to work with.
+ * @param[in] write The function called with consecutive parts of the dump.
+ * @param[in] arg   Argument passed to `write`.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rec` or `write` argument is NULL
+ *    - ESP_ERR_INVALID_STATE if the recorder is not created
+ *    - the first error returned by `write`
+ *
+ * @code{c}
+ * static esp_err_t write_stdout(const void *data, size_t length, void *arg)
+ * {
+ *     return (fwrite(data, 1, length, stdout) == length) ? ESP_OK : ESP_FAIL;
+ * }
+ * ...
+ * dled_recorder_enable(&rec, false);
+ * dled_recorder_dump(&rec, write_stdout, NULL);
+ * dled_recorder_enable(&rec, true);
+ * @endcode
+ */
+esp_err_t dled_recorder_dump(const dled_recorder_t *rec, dled_recorder_write_fn_t write, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_replay.h"
+#include "dled_recorder.h"
+#include "dled_wire_sim.h"
+#include "esp32_rmt_dled.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_replay";
+
+static uint16_t dled_replay_get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t dled_replay_get32(const uint8_t *p)
+{
+    return dled_replay_get16(p) | ((uint32_t)dled_replay_get16(p + 2) << 16);
+}
+
+static void dled_replay_result_init(dled_replay_result_t *result)
+{
+    result->frames = 0;
+    result->mismatches = 0;
+    result->violations = 0;
+    result->violation_flags = 0;
+    result->first_bad_frame = -1;
+    result->max_wire_time_ps = 0;
+    result->max_interval_us = 0;
+    result->overruns = 0;
+}
+
+/* replays the frames once the strip, the rmt_pixel_strip_t and the simulator are created */
+static esp_err_t dled_replay_frames(const uint8_t *data, size_t length, uint32_t count, uint32_t frame_size,
+                                    rmt_pixel_strip_t *rps, dled_wire_sim_t *sim, dled_replay_result_t *result)
+{
+    pixel_strip_t *strip = rps->strip;
+    int64_t prev_ts = 0;
+    uint64_t prev_wire_ps = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (length < DLED_RECORDER_FRAME_HEADER_SIZE) {
+            ESP_LOGE(LOG_TAG, "Frame %d truncated", i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        int64_t ts = (int64_t)((uint64_t)dled_replay_get32(data) | ((uint64_t)dled_replay_get32(data + 4) << 32));
+        uint32_t frame_length = dled_replay_get32(data + 8);
+        data += DLED_RECORDER_FRAME_HEADER_SIZE;
+        length -= DLED_RECORDER_FRAME_HEADER_SIZE;
+
+        if (frame_length > frame_size || frame_length > length ||
+            frame_length == 0 || frame_length % strip->bytes_per_led != 0) {
+            ESP_LOGE(LOG_TAG, "Frame %d has invalid length %d", i, frame_length);
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        if (frame_length != strip->buffer_length) {
+            esp_err_t ret_val = rmt_dled_resize(rps, frame_length / strip->bytes_per_led);
+            if (ret_val != ESP_OK) return ret_val;
+        }
+        memcpy(strip->buffer, data, frame_length);
+        strip->generation++;
+        rmt_dled_encode(rps);
+
+        uint32_t violations = sim->violations;
+        dled_wire_sim_feed(sim, rps->ugly_buffer, (uint32_t)strip->buffer_length * 8);
+        dled_wire_sim_end(sim);
+
+        bool bad = false;
+        if (sim->violations != violations) {
+            result->violations += sim->violations - violations;
+            bad = true;
+        }
+        if (!dled_wire_sim_latched_equals(sim, data, frame_length)) {
+            result->mismatches++;
+            bad = true;
+        }
+        if (bad && result->first_bad_frame < 0) result->first_bad_frame = i;
+
+        if (sim->last_frame_time_ps > result->max_wire_time_ps)
+            result->max_wire_time_ps = sim->last_frame_time_ps;
+        if (i != 0) {
+            int64_t interval = ts - prev_ts;
+            if (interval > result->max_interval_us) result->max_interval_us = interval;
+            if (interval >= 0 && (uint64_t)interval * 1000000ULL < prev_wire_ps) result->overruns++;
+        }
+        prev_ts = ts;
+        prev_wire_ps = sim->last_frame_time_ps;
+
+        result->frames++;
+        data += frame_length;
+        length -= frame_length;
+    }
+    result->violation_flags = sim->violation_flags;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_replay(const uint8_t *dump, size_t length, dled_replay_result_t *result)
+{
+	if (dump == NULL || result == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    dled_replay_result_init(result);
+
+	if (length < DLED_RECORDER_HEADER_SIZE || memcmp(dump, "DLRC", 4) != 0 || dump[4] != DLED_RECORDER_VERSION) {
+		ESP_LOGE(LOG_TAG, "Not a recorder dump");
+		return ESP_ERR_INVALID_VERSION;
+	}
+
+    dstrip_type_t type = (dstrip_type_t)dump[5];
+    uint8_t bytes_per_led = dump[6];
+    uint32_t frame_size = dled_replay_get32(dump + 20);
+    uint32_t count = dled_replay_get32(dump + 24);
+	/* the replay strip's buffer and pixels must fit dled_strip_create's 16 bit sizes */
+	if (bytes_per_led == 0 || frame_size == 0 || frame_size % bytes_per_led != 0 ||
+	    frame_size > UINT16_MAX || frame_size / bytes_per_led * sizeof(pixel_t) > UINT16_MAX) {
+		ESP_LOGE(LOG_TAG, "Invalid frame size");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    pixel_strip_t strip;
+    rmt_pixel_strip_t rps;
+    dled_wire_sim_t sim;
+    dled_wire_sim_config_t sim_config;
+    dled_strip_init(&strip);
+    rmt_dled_init(&rps);
+    dled_wire_sim_init(&sim);
+
+    uint16_t leds = (uint16_t)(frame_size / bytes_per_led);
+    esp_err_t ret_val = dled_strip_create(&strip, type, leds, 255);
+    if (ret_val == ESP_OK && strip.bytes_per_led != bytes_per_led) {
+        ESP_LOGE(LOG_TAG, "Bytes per LED do not match the strip type");
+        ret_val = ESP_ERR_INVALID_VERSION;
+    }
+    /* the recorded timings may be custom ones */
+    if (ret_val == ESP_OK) {
+        ret_val = dled_strip_set_custom_timings(&strip,
+                      dled_replay_get16(dump + 8),  dled_replay_get16(dump + 10),
+                      dled_replay_get16(dump + 12), dled_replay_get16(dump + 14),
+                      dled_replay_get32(dump + 16));
+    }
+    if (ret_val == ESP_OK) ret_val = rmt_dled_create(&rps, &strip);
+    if (ret_val == ESP_OK) ret_val = dled_wire_sim_config_from_datasheet(&sim_config, &strip, rmt_dled_tick_ps(&rps));
+    if (ret_val == ESP_OK) ret_val = dled_wire_sim_create(&sim, &sim_config, leds);
+
+    if (ret_val == ESP_OK) {
+        ret_val = dled_replay_frames(dump + DLED_RECORDER_HEADER_SIZE, length - DLED_RECORDER_HEADER_SIZE,
+                                     count, frame_size, &rps, &sim, result);
+    }
+    else {
+        ESP_LOGE(LOG_TAG, "[0x%x] Failed to create the replay strip", ret_val);
+    }
+
+    dled_wire_sim_destroy(&sim);
+    if (rps.ugly_buffer != NULL) { free(rps.ugly_buffer); }
+    rmt_dled_init(&rps);
+    dled_strip_destroy(&strip);
+
+    return ret_val;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+#ifndef MAIN_DLED_REPLAY_H_
+#define MAIN_DLED_REPLAY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * @brief Results of a replay.
+ *
+ */
+typedef struct {
+    uint32_t frames;            /*!< Number of frames replayed */
+    uint32_t mismatches;        /*!< Number of frames latched by the simulated LEDs different from the recorded ones */
+    uint32_t violations;        /*!< Number of timing violations, see dled_sim_violation_t */
+    uint8_t  violation_flags;   /*!< OR of all dled_sim_violation_t found */
+    int32_t  first_bad_frame;   /*!< Index of the first mismatched frame or frame with violations, -1 if none */
+    uint64_t max_wire_time_ps;  /*!< Longest wire time of a frame, including the reset */
+    int64_t  max_interval_us;   /*!< Longest time between two captured frames */
+    uint32_t overruns;          /*!< Number of frames captured before the previous one could be on the wire */
+} dled_replay_result_t;
+
+/**
+ * @brief Replay a dump of dled_recorder_dump
+ *
+ * Creates a strip and a rmt_pixel_strip_t with the recorded type and timings, without
+ * configuring the RMT driver, then every frame is encoded with rmt_dled_encode and fed
+ * to a dled_wire_sim_t with the datasheet windows of the recorded type, see
+ * dled_wire_sim_config_from_datasheet. The latched LEDs are compared with the recorded frame.
+ *
+ * Runs on the ESP32 as well as on a host, where it is the core of an offline replay tool:
+ *
+ * @code{c}
+ * ... // read the dump file in `dump`
+ * dled_replay_result_t result;
+ * if (dled_replay(dump, dump_length, &result) == ESP_OK) {
+ *     printf("%u frames, %u mismatches, %u violations, first bad frame %d\n",
+ *            result.frames, result.mismatches, result.violations, result.first_bad_frame);
+ * }
+ * @endcode
+ *
+ * @param[in]  dump   The dump.
+ * @param[in]  length Length of the dump, in bytes.
+ * @param[out] result The results.
+ *
+ * @return
+ *    - ESP_OK success, even if frames mismatched or had violations
+ *    - ESP_ERR_INVALID_ARG if the `dump` or `result` argument is NULL
+ *    - ESP_ERR_INVALID_VERSION if the dump is not a dump or has another version
+ *    - ESP_ERR_INVALID_SIZE if the dump is truncated or a frame is longer than the frame size
+ *    - the error codes of dled_strip_create, rmt_dled_create and dled_wire_sim_create
+ */
+esp_err_t dled_replay(const uint8_t *dump, size_t length, dled_replay_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
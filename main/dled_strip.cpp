@@ -4,6 +4,8 @@ extern "C" {
 
 #include "dled_strip.h"
 
+#include <stdlib.h>
+#include <string.h>
 #include "esp_log.h"
 
 static const char *LOG_TAG  = "dled_strip";
@@ -15,8 +17,10 @@ esp_err_t dled_strip_init(pixel_strip_t *strip)
     strip->type = DLED_NULL;
     strip->pixels = NULL;
     strip->length = 0;
+    strip->capacity = 0;
     strip->buffer = NULL;
     strip->buffer_length = 0;
+    strip->generation = 0;
     strip->bytes_per_led = 0;
     strip->max_cc_val = 0;
     strip->T0H = 0; strip->T0L = 0;
@@ -49,45 +53,90 @@ void dled_strip_set_timings(pixel_strip_t *strip)
         case DLED_WS281x:
             strip->T0H = 400; strip->T0L = 850; strip->T1H = 850; strip->T1L = 400; strip->TRS = 50000;
             break;
+        /* Fast profiles are not from datasheets. The bit period is shortened to 0.95 us by cutting
+         * the low times, the high times of 0 and 1 stay well apart. */
+        case DLED_WS2812B_FAST:
+            strip->T0H = 300; strip->T0L = 650; strip->T1H = 700; strip->T1L = 250; strip->TRS = 280000;
+            break;
+        case DLED_WS281x_FAST:
+            strip->T0H = 250; strip->T0L = 700; strip->T1H = 700; strip->T1L = 250; strip->TRS = 50000;
+            break;
     }
 }
 
-esp_err_t dled_strip_create(pixel_strip_t *strip, dstrip_type_t strip_type, uint16_t length, uint8_t max_cc_val_in)
+esp_err_t dled_strip_set_custom_timings(pixel_strip_t *strip, uint16_t T0H, uint16_t T0L, uint16_t T1H, uint16_t T1L, uint32_t TRS)
 {
-    uint16_t req_length;
-
 	if (strip == NULL) {
 		ESP_LOGE(LOG_TAG, "Argument is NULL");
 		return ESP_ERR_INVALID_ARG;
 	}
-	if (length == 0) {
-		ESP_LOGE(LOG_TAG, "Number of pixels is 0");
-		return ESP_ERR_INVALID_SIZE;
+	if (T0H == 0 || T0L == 0 || T1H == 0 || T1L == 0 || TRS == 0) {
+		ESP_LOGE(LOG_TAG, "Timings must not be zero");
+		return ESP_ERR_INVALID_ARG;
 	}
 
-    strip->type = strip_type;
-    switch(strip->type) {
+    strip->T0H = T0H; strip->T0L = T0L;
+    strip->T1H = T1H; strip->T1L = T1L;
+    strip->TRS = TRS;
+
+    return ESP_OK;
+}
+
+/* Returns the number of bytes per LED, 0 for DLED_NULL and unknown types */
+static uint8_t dled_strip_type_bytes(dstrip_type_t strip_type)
+{
+    switch(strip_type) {
         case DLED_NULL:
-            strip->bytes_per_led = 0;
-            break;
+            return 0;
         case DLED_WS2812:
         case DLED_WS2812B:
         case DLED_WS2812D:
         case DLED_WS2813:
         case DLED_WS2815:
         case DLED_WS281x:
-            strip->bytes_per_led = 3;
-            break;
+        case DLED_WS2812B_FAST:
+        case DLED_WS281x_FAST:
+            return 3;
         default:
     		ESP_LOGE(LOG_TAG, "Unknown strip type");
-            strip->type = DLED_NULL;
-            break;
+            return 0;
+    }
+}
+
+/* `buffer_length` and the allocation sizes are 16 bits */
+static bool dled_strip_length_fits(uint16_t length, uint8_t bytes_per_led)
+{
+    return (uint32_t)length * bytes_per_led <= UINT16_MAX && (uint32_t)length * sizeof(pixel_t) <= UINT16_MAX;
+}
+
+esp_err_t dled_strip_create(pixel_strip_t *strip, dstrip_type_t strip_type, uint16_t length, uint8_t max_cc_val_in)
+{
+    uint16_t req_length;
+
+	if (strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (length == 0) {
+		ESP_LOGE(LOG_TAG, "Number of pixels is 0");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    strip->type = strip_type;
+    strip->bytes_per_led = dled_strip_type_bytes(strip->type);
+    if (strip->bytes_per_led == 0) {
+        strip->type = DLED_NULL;
     }
 
     if(strip->type == DLED_NULL){
         dled_strip_init(strip);
 		return ESP_ERR_INVALID_ARG;
     }
+    if (!dled_strip_length_fits(length, strip->bytes_per_led)) {
+        dled_strip_init(strip);
+		ESP_LOGE(LOG_TAG, "Too many pixels: %d", length);
+		return ESP_ERR_INVALID_SIZE;
+    }
 
     req_length = length * sizeof(pixel_t);
 	strip->pixels = (pixel_t*)malloc(req_length);
@@ -113,6 +162,7 @@ esp_err_t dled_strip_create(pixel_strip_t *strip, dstrip_type_t strip_type, uint
     }
 
     strip->length = length;
+    strip->capacity = length;
     strip->buffer_length = length * strip->bytes_per_led;
 
     strip->max_cc_val = max_cc_val_in;
@@ -125,6 +175,79 @@ esp_err_t dled_strip_create(pixel_strip_t *strip, dstrip_type_t strip_type, uint
     return ESP_OK;
 }
 
+esp_err_t dled_strip_resize(pixel_strip_t *strip, uint16_t length)
+{
+	if (strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (strip->pixels == NULL || strip->buffer == NULL) {
+		ESP_LOGE(LOG_TAG, "Strip not created");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (length == 0) {
+		ESP_LOGE(LOG_TAG, "Number of pixels is 0");
+		return ESP_ERR_INVALID_SIZE;
+	}
+	if (!dled_strip_length_fits(length, strip->bytes_per_led)) {
+		ESP_LOGE(LOG_TAG, "Too many pixels: %d", length);
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    /* memory is reallocated only when growing */
+    if (length > strip->capacity) {
+        pixel_t *pixels = (pixel_t*)realloc(strip->pixels, length * sizeof(pixel_t));
+        if (pixels == NULL) {
+            ESP_LOGE(LOG_TAG, "Failed to reallocate memory for pixels");
+            return ESP_ERR_NO_MEM;
+        }
+        strip->pixels = pixels;
+
+        uint8_t *buffer = (uint8_t*)realloc(strip->buffer, (uint32_t)length * strip->bytes_per_led);
+        if (buffer == NULL) {
+            ESP_LOGE(LOG_TAG, "Failed to reallocate memory for buffer");
+            return ESP_ERR_NO_MEM;
+        }
+        strip->buffer = buffer;
+
+        strip->capacity = length;
+    }
+
+    /* new pixels are off, in `pixels` and in `buffer` */
+    for (uint16_t i = strip->length; i < length; i++)
+        dled_pixel_off(&strip->pixels[i]);
+    if (length > strip->length)
+        memset(strip->buffer + strip->buffer_length, 0, (length - strip->length) * strip->bytes_per_led);
+
+    strip->length = length;
+    strip->buffer_length = length * strip->bytes_per_led;
+    strip->generation++;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_strip_set_type(pixel_strip_t *strip, dstrip_type_t strip_type)
+{
+	if (strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    uint8_t bytes_per_led = dled_strip_type_bytes(strip_type);
+    if (bytes_per_led == 0) {
+		return ESP_ERR_INVALID_ARG;
+    }
+    if (bytes_per_led != strip->bytes_per_led) {
+		ESP_LOGE(LOG_TAG, "Number of bytes per LED differs");
+		return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    strip->type = strip_type;
+    dled_strip_set_timings(strip);
+
+    return ESP_OK;
+}
+
 esp_err_t dled_strip_destroy(pixel_strip_t *strip)
 {
 	if (strip == NULL) {
@@ -149,19 +272,84 @@ esp_err_t dled_strip_fill_buffer(pixel_strip_t *strip)
 		return ESP_ERR_INVALID_ARG;
 	}
 
+    return dled_strip_fill_buffer_from_pixels(strip, strip->pixels);
+}
+
+esp_err_t dled_strip_fill_buffer_from_pixels(pixel_strip_t *strip, const pixel_t *pixels)
+{
+	if (strip == NULL || pixels == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
     /* To not waste CPU cycles I do not check if:
      *    strip->buffer != NULL
-     *    strip->pixels != NULL
      *    the sizes are OK
      * because here these "should" be right. */
 
     /* WS2812, WS2812B and WS2813 are GRB */
 	uint16_t didx = 0;
     for(uint16_t i = 0; i < strip->length; i++){
-        strip->buffer[didx++] = strip->pixels[i].g;
-        strip->buffer[didx++] = strip->pixels[i].r;
-        strip->buffer[didx++] = strip->pixels[i].b;
+        strip->buffer[didx++] = pixels[i].g;
+        strip->buffer[didx++] = pixels[i].r;
+        strip->buffer[didx++] = pixels[i].b;
+	}
+    strip->generation++;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_strip_fill_buffer_from_planes(pixel_strip_t *strip, const pixel_planes_t *planes)
+{
+	if (strip == NULL || planes == NULL || planes->memory == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (planes->length < strip->length) {
+		ESP_LOGE(LOG_TAG, "Planes have %d pixels, strip has %d", planes->length, strip->length);
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    /* WS2812, WS2812B and WS2813 are GRB */
+    const uint8_t *r = planes->r;
+    const uint8_t *g = planes->g;
+    const uint8_t *b = planes->b;
+    uint8_t *dst = strip->buffer;
+    for (uint16_t i = 0; i < strip->length; i++) {
+        *dst++ = g[i];
+        *dst++ = r[i];
+        *dst++ = b[i];
+    }
+    strip->generation++;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_strip_apply_updates(pixel_strip_t *strip, const pixel_update_t *updates, uint16_t count)
+{
+	if (strip == NULL || updates == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
 	}
+    for (uint16_t i = 0; i < count; i++) {
+        if (updates[i].index >= strip->length) {
+            ESP_LOGE(LOG_TAG, "Pixel index %d out of range", updates[i].index);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    /* WS2812, WS2812B and WS2813 are GRB */
+    uint8_t bpl = strip->bytes_per_led;
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t idx = updates[i].index;
+        uint32_t didx = (uint32_t)idx * bpl;
+
+        strip->pixels[idx] = updates[i].color;
+        strip->buffer[didx++] = updates[i].color.g;
+        strip->buffer[didx++] = updates[i].color.r;
+        strip->buffer[didx]   = updates[i].color.b;
+    }
+    strip->generation++;
 
     return ESP_OK;
 }
@@ -6,6 +6,7 @@ extern "C" {
 #endif
 
 #include "dled_pixel.h"
+#include "dled_pixel_planes.h"
 
 #include "esp_err.h"
 
@@ -20,7 +21,9 @@ typedef enum {
     DLED_WS2812D,
     DLED_WS2813,
     DLED_WS2815,
-    DLED_WS281x    /*!< This value should work for all WS281* and clones */
+    DLED_WS281x,        /*!< This value should work for all WS281* and clones */
+    DLED_WS2812B_FAST,  /*!< Overclocked WS2812B, 0.95 us bits, for LEDs tolerating shorter bits */
+    DLED_WS281x_FAST    /*!< Overclocked WS281x, 0.95 us bits and 50 us reset, test before using it */
 } dstrip_type_t;
 
 /**
@@ -30,9 +33,11 @@ typedef enum {
 typedef struct {
 	pixel_t* pixels;        /*!< these are the pixels, one for each LED */
 	uint16_t length;        /*!< the number of pixels */
+	uint16_t capacity;      /*!< the number of pixels allocated */
 
 	uint8_t* buffer;        /*!< buffer to hold data to be sent to LEDs */
 	uint16_t buffer_length; /*!< length, in bytes, of buffer */
+	uint32_t generation;    /*!< incremented by every function writing `buffer`, increment it after writing `buffer` directly */
 
 	uint8_t max_cc_val;     /*!< maximum value allowed for a color component */
 
@@ -42,6 +47,15 @@ typedef struct {
     uint32_t TRS;                /*!< reset timing of the communication protocol */
 } pixel_strip_t;
 
+/**
+ * @brief A change of one pixel, used for sparse updates.
+ *
+ */
+typedef struct {
+    uint16_t index; /*!< Index of the pixel */
+    pixel_t  color; /*!< The new color */
+} pixel_update_t;
+
 /**
  * @brief Initialize a pixel_strip_t structure.
  *
@@ -67,11 +81,43 @@ esp_err_t dled_strip_init(pixel_strip_t *strip);
  * @return
  *    - ESP_OK success
  *    - ESP_ERR_INVALID_ARG if the `strip` argument is NULL __OR__ `strip_type` is unknown or DSTRIP_NULL
- *    - ESP_ERR_INVALID_SIZE if length is zero
+ *    - ESP_ERR_INVALID_SIZE if length is zero __OR__ the buffer of `length` LEDs is longer than 65535 bytes
  *    - ESP_ERR_NO_MEM if failed to allocate memory for `pixels` or `buffer`
  */
 esp_err_t dled_strip_create(pixel_strip_t *strip, dstrip_type_t strip_type, uint16_t length, uint8_t max_cc_val);
 
+/**
+ * @brief Change the number of pixels of a pixel_strip_t structure.
+ *
+ * The buffers are reallocated only when `length` is greater than `capacity`, so shrinking
+ * and growing back does not allocate. Existing pixels are kept, new pixels are off.
+ *
+ * @param[in,out] strip  The structure to work with, created by dled_strip_create.
+ * @param[in]     length The new number of digital LEDs.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` argument is NULL or the strip is not created
+ *    - ESP_ERR_INVALID_SIZE if length is zero __OR__ the buffer of `length` LEDs is longer than 65535 bytes
+ *    - ESP_ERR_NO_MEM if failed to reallocate memory, the strip is not changed
+ */
+esp_err_t dled_strip_resize(pixel_strip_t *strip, uint16_t length);
+
+/**
+ * @brief Change the type of digital LEDs of a pixel_strip_t structure.
+ *
+ * Sets the type and its timings. The number of bytes per LED must not change.
+ *
+ * @param[in,out] strip      The structure to work with, created by dled_strip_create.
+ * @param[in]     strip_type The type of digital LEDs.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` argument is NULL __OR__ `strip_type` is unknown or DSTRIP_NULL
+ *    - ESP_ERR_NOT_SUPPORTED if the new type has a different number of bytes per LED
+ */
+esp_err_t dled_strip_set_type(pixel_strip_t *strip, dstrip_type_t strip_type);
+
 /**
  * @brief Destroy the buffers of a pixel_strip_t structure.
  *
@@ -86,6 +132,22 @@ esp_err_t dled_strip_create(pixel_strip_t *strip, dstrip_type_t strip_type, uint
  */
 esp_err_t dled_strip_destroy(pixel_strip_t *strip);
 
+/**
+ * @brief Set custom timings of the communication protocol
+ *
+ * Overrides the timings set by dled_strip_create for clones not matching any datasheet.
+ * Call it before rmt_dled_create, which computes the RMT durations from these timings.
+ *
+ * @param[in,out] strip              The structure to work with.
+ * @param[in]     T0H, T0L, T1H, T1L Durations of the high and low parts of 0 and 1 bits, in ns.
+ * @param[in]     TRS                Duration of reset, in ns.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` argument is NULL __OR__ a duration is zero
+ */
+esp_err_t dled_strip_set_custom_timings(pixel_strip_t *strip, uint16_t T0H, uint16_t T0L, uint16_t T1H, uint16_t T1L, uint32_t TRS);
+
 /**
  * @brief Fill structure's `buffer` from structure's `pixels`
  *
@@ -99,6 +161,53 @@ esp_err_t dled_strip_destroy(pixel_strip_t *strip);
  */
 esp_err_t dled_strip_fill_buffer(pixel_strip_t *strip);
 
+/**
+ * @brief Fill structure's `buffer` from an array of pixels
+ *
+ * Like dled_strip_fill_buffer but the pixels are not the structure's `pixels`.
+ * Used when pixels are rendered in other buffers, like the frames of a dled_frame_queue_t.
+ *
+ * @param[in,out] strip  The structure to work with.
+ * @param[in]     pixels The pixels, at least `strip->length` of them.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` or `pixels` argument is NULL
+ */
+esp_err_t dled_strip_fill_buffer_from_pixels(pixel_strip_t *strip, const pixel_t *pixels);
+
+/**
+ * @brief Fill structure's `buffer` from color planes
+ *
+ * Like dled_strip_fill_buffer but the pixels are stored as separate color planes,
+ * they are interleaved in wire order here.
+ *
+ * @param[in,out] strip  The structure to work with.
+ * @param[in]     planes The color planes, at least `strip->length` pixels.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` or `planes` argument is NULL
+ *    - ESP_ERR_INVALID_SIZE if `planes` has less pixels than the strip
+ */
+esp_err_t dled_strip_fill_buffer_from_planes(pixel_strip_t *strip, const pixel_planes_t *planes);
+
+/**
+ * @brief Apply a batch of pixel changes to `pixels` and `buffer`
+ *
+ * Only the changed pixels are written, in both `pixels` and `buffer`, so calling
+ * dled_strip_fill_buffer is not needed. If an index is out of range nothing is changed.
+ *
+ * @param[in,out] strip   The structure to work with.
+ * @param[in]     updates The changes, applied in order.
+ * @param[in]     count   Number of changes.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` or `updates` argument is NULL __OR__ an index is out of range
+ */
+esp_err_t dled_strip_apply_updates(pixel_strip_t *strip, const pixel_update_t *updates, uint16_t count);
+
 #ifdef __cplusplus
 }
 #endif
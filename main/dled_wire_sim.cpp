@@ -0,0 +1,282 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "dled_wire_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char *LOG_TAG  = "dled_wire_sim";
+
+/**
+ * @brief Accepted durations of a LED type, in nanoseconds.
+ *
+ */
+typedef struct {
+    dstrip_type_t type;
+    uint16_t t0h_min, t0h_max;
+    uint16_t t1h_min, t1h_max;
+    uint16_t t0l_min, t0l_max;
+    uint16_t t1l_min, t1l_max;
+    uint32_t reset_min;
+} dled_datasheet_t;
+
+/* Windows from the datasheets, not from dled_strip_set_timings.
+ * WS2812B (V5), WS2813 and WS2815 share the same windows. WS2812, WS2812D and the generic
+ * WS281x give nominal values with a 150 ns tolerance. The fast types must stay within the
+ * windows of the LEDs they overclock. */
+static const dled_datasheet_t dled_datasheets[] = {
+    /*  type                t0h       t1h        t0l        t1l       reset */
+    { DLED_WS2812,       200,  500,  550,  850,  650,  950,  450,  750,  50000 },
+    { DLED_WS2812B,      220,  380,  580, 1600,  580, 1600,  220,  420, 280000 },
+    { DLED_WS2812D,      250,  550,  650,  950,  700, 1000,  300,  600,  50000 },
+    { DLED_WS2813,       220,  380,  580, 1600,  580, 1600,  220,  420, 280000 },
+    { DLED_WS2815,       220,  380,  580, 1600,  580, 1600,  220,  420, 280000 },
+    { DLED_WS281x,       250,  550,  700, 1000,  700, 1000,  250,  550,  50000 },
+    { DLED_WS2812B_FAST, 220,  380,  580, 1600,  580, 1600,  220,  420, 280000 },
+    { DLED_WS281x_FAST,  250,  550,  700, 1000,  700, 1000,  250,  550,  50000 },
+};
+
+esp_err_t dled_wire_sim_config_from_datasheet(dled_wire_sim_config_t *config, const pixel_strip_t *strip,
+                                              uint32_t tick_ps)
+{
+	if (config == NULL || strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    const dled_datasheet_t *ds = NULL;
+    for (uint8_t i = 0; i < sizeof(dled_datasheets) / sizeof(dled_datasheets[0]); i++) {
+        if (dled_datasheets[i].type == strip->type) ds = &dled_datasheets[i];
+    }
+	if (ds == NULL) {
+		ESP_LOGE(LOG_TAG, "No datasheet for strip type %d", strip->type);
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    config->tick_ps = tick_ps;
+    config->t0h_min = ds->t0h_min; config->t0h_max = ds->t0h_max;
+    config->t1h_min = ds->t1h_min; config->t1h_max = ds->t1h_max;
+    config->t0l_min = ds->t0l_min; config->t0l_max = ds->t0l_max;
+    config->t1l_min = ds->t1l_min; config->t1l_max = ds->t1l_max;
+    config->reset_min = ds->reset_min;
+    config->bytes_per_led = strip->bytes_per_led;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_wire_sim_config_from_strip(dled_wire_sim_config_t *config, const pixel_strip_t *strip,
+                                          uint32_t tick_ps, uint16_t tolerance_ns)
+{
+	if (config == NULL || strip == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (strip->type == DLED_NULL) {
+		ESP_LOGE(LOG_TAG, "Strip type not set");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    config->tick_ps = tick_ps;
+    config->t0h_min = (strip->T0H > tolerance_ns) ? strip->T0H - tolerance_ns : 0;
+    config->t0h_max = strip->T0H + tolerance_ns;
+    config->t1h_min = (strip->T1H > tolerance_ns) ? strip->T1H - tolerance_ns : 0;
+    config->t1h_max = strip->T1H + tolerance_ns;
+    config->t0l_min = (strip->T0L > tolerance_ns) ? strip->T0L - tolerance_ns : 0;
+    config->t0l_max = strip->T0L + tolerance_ns;
+    config->t1l_min = (strip->T1L > tolerance_ns) ? strip->T1L - tolerance_ns : 0;
+    config->t1l_max = strip->T1L + tolerance_ns;
+    config->reset_min = strip->TRS;
+    config->bytes_per_led = strip->bytes_per_led;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_wire_sim_init(dled_wire_sim_t *sim)
+{
+    if (sim == NULL) { return ESP_ERR_INVALID_ARG; }
+
+    memset(&sim->config, 0, sizeof(sim->config));
+    sim->led_count = 0;
+    sim->data_length = 0;
+
+    sim->shift = NULL;
+    sim->latched = NULL;
+    sim->bits = 0;
+    sim->frame_time_ps = 0;
+
+    sim->frames = 0;
+    sim->last_frame_time_ps = 0;
+    sim->last_frame_bits = 0;
+
+    sim->items = 0;
+    sim->violations = 0;
+    sim->violation_flags = 0;
+    sim->first_violation = -1;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_wire_sim_create(dled_wire_sim_t *sim, const dled_wire_sim_config_t *config, uint16_t led_count)
+{
+	if (sim == NULL || config == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (led_count == 0 || config->bytes_per_led == 0 || config->tick_ps == 0) {
+		ESP_LOGE(LOG_TAG, "Invalid size");
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+    dled_wire_sim_init(sim);
+
+    uint32_t req_length = (uint32_t)led_count * config->bytes_per_led;
+    sim->shift = (uint8_t*)calloc(req_length, 1);
+    sim->latched = (uint8_t*)calloc(req_length, 1);
+    if (sim->shift == NULL || sim->latched == NULL) {
+        dled_wire_sim_destroy(sim);
+		ESP_LOGE(LOG_TAG, "Failed to allocate memory for LED chain");
+		return ESP_ERR_NO_MEM;
+    }
+
+    sim->config = *config;
+    sim->led_count = led_count;
+    sim->data_length = req_length;
+
+    return ESP_OK;
+}
+
+esp_err_t dled_wire_sim_destroy(dled_wire_sim_t *sim)
+{
+	if (sim == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (sim->shift != NULL)   { free(sim->shift); }
+    if (sim->latched != NULL) { free(sim->latched); }
+
+    dled_wire_sim_init(sim);
+
+    return ESP_OK;
+}
+
+static void dled_wire_sim_violation(dled_wire_sim_t *sim, dled_sim_violation_t violation)
+{
+    if (sim->first_violation < 0) sim->first_violation = sim->items;
+    sim->violation_flags |= violation;
+    sim->violations++;
+}
+
+static void dled_wire_sim_latch(dled_wire_sim_t *sim)
+{
+    uint32_t led_bits = (uint32_t)sim->config.bytes_per_led * 8;
+
+    if (sim->bits % led_bits != 0)
+        dled_wire_sim_violation(sim, DLED_SIM_PARTIAL_LED);
+
+    /* only the LEDs which received all their bits change */
+    uint32_t length = (sim->bits / led_bits) * sim->config.bytes_per_led;
+    if (length > sim->data_length) length = sim->data_length;
+    memcpy(sim->latched, sim->shift, length);
+
+    uint32_t used = (sim->bits + 7) / 8;
+    if (used > sim->data_length) used = sim->data_length;
+    memset(sim->shift, 0, used);
+
+    sim->frames++;
+    sim->last_frame_time_ps = sim->frame_time_ps;
+    sim->last_frame_bits = sim->bits;
+    sim->bits = 0;
+    sim->frame_time_ps = 0;
+}
+
+esp_err_t dled_wire_sim_feed(dled_wire_sim_t *sim, const rmt_item32_t *items, uint32_t count)
+{
+	if (sim == NULL || items == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (sim->shift == NULL) {
+		ESP_LOGE(LOG_TAG, "LED chain not created");
+		return ESP_ERR_INVALID_STATE;
+	}
+
+    const dled_wire_sim_config_t *cfg = &sim->config;
+
+    for (uint32_t i = 0; i < count; i++, sim->items++) {
+        rmt_item32_t item = items[i];
+        if (item.duration0 == 0) break;
+
+        uint64_t high_ps = (uint64_t)item.duration0 * cfg->tick_ps;
+        uint64_t low_ps  = (uint64_t)item.duration1 * cfg->tick_ps;
+        sim->frame_time_ps += high_ps + low_ps;
+
+        if (item.level0 != 1 || item.level1 != 0) {
+            dled_wire_sim_violation(sim, DLED_SIM_BAD_LEVEL);
+            continue;
+        }
+
+        /* the LED samples the line at a fixed moment, between the 0 and 1 high times */
+        uint8_t bit;
+        if (high_ps >= cfg->t0h_min * 1000ULL && high_ps <= cfg->t0h_max * 1000ULL) {
+            bit = 0;
+        }
+        else if (high_ps >= cfg->t1h_min * 1000ULL && high_ps <= cfg->t1h_max * 1000ULL) {
+            bit = 1;
+        }
+        else {
+            dled_wire_sim_violation(sim, DLED_SIM_HIGH_INVALID);
+            bit = (high_ps * 2 > (uint64_t)(cfg->t0h_max + cfg->t1h_min) * 1000ULL) ? 1 : 0;
+        }
+
+        /* bits past the end of the chain are forwarded by the last LED */
+        if (sim->bits < sim->data_length * 8) {
+            if (bit != 0)
+                sim->shift[sim->bits >> 3] |= 0x80 >> (sim->bits & 7);
+        }
+        sim->bits++;
+
+        if (low_ps >= cfg->reset_min * 1000ULL) {
+            dled_wire_sim_latch(sim);
+            continue;
+        }
+
+        uint32_t low_min = bit ? cfg->t1l_min : cfg->t0l_min;
+        uint32_t low_max = bit ? cfg->t1l_max : cfg->t0l_max;
+        if (low_ps < low_min * 1000ULL) dled_wire_sim_violation(sim, DLED_SIM_LOW_SHORT);
+        if (low_ps > low_max * 1000ULL) dled_wire_sim_violation(sim, DLED_SIM_LOW_LONG);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t dled_wire_sim_end(dled_wire_sim_t *sim)
+{
+	if (sim == NULL) {
+		ESP_LOGE(LOG_TAG, "Argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    if (sim->bits != 0 && sim->shift != NULL) {
+        dled_wire_sim_violation(sim, DLED_SIM_NO_RESET);
+        dled_wire_sim_latch(sim);
+    }
+
+    return ESP_OK;
+}
+
+bool dled_wire_sim_latched_equals(const dled_wire_sim_t *sim, const uint8_t *buffer, uint32_t length)
+{
+    if (sim == NULL || buffer == NULL) return false;
+    if (sim->latched == NULL)          return false;
+    if (length > sim->data_length)     return false;
+
+    return memcmp(sim->latched, buffer, length) == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,202 @@
+#ifndef MAIN_DLED_WIRE_SIM_H_
+#define MAIN_DLED_WIRE_SIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "soc/rmt_struct.h"
+
+#include "dled_strip.h"
+
+/**
+ * @brief Timing violations found by the simulator, used as bit flags.
+ *
+ */
+typedef enum {
+    DLED_SIM_HIGH_INVALID = 0x01, /*!< High time is in neither the 0 nor the 1 window */
+    DLED_SIM_LOW_SHORT    = 0x02, /*!< Low time is shorter than the minimum */
+    DLED_SIM_LOW_LONG     = 0x04, /*!< Low time is longer than the maximum but shorter than reset */
+    DLED_SIM_NO_RESET     = 0x08, /*!< The stream ended without a reset */
+    DLED_SIM_PARTIAL_LED  = 0x10, /*!< The number of bits of a frame is not a multiple of a LED's bits */
+    DLED_SIM_BAD_LEVEL    = 0x20  /*!< The item is not a high level followed by a low level */
+} dled_sim_violation_t;
+
+/**
+ * @brief Timing windows of the simulated LEDs, all times in nanoseconds.
+ *
+ */
+typedef struct {
+    uint32_t tick_ps;            /*!< Duration of a RMT tick, in picoseconds */
+    uint32_t t0h_min, t0h_max;   /*!< High time of a 0 bit */
+    uint32_t t1h_min, t1h_max;   /*!< High time of a 1 bit */
+    uint32_t t0l_min, t0l_max;   /*!< Low time of a 0 bit */
+    uint32_t t1l_min, t1l_max;   /*!< Low time of a 1 bit */
+    uint32_t reset_min;          /*!< Minimum low time which latches the data */
+    uint8_t  bytes_per_led;      /*!< Number of bytes per LED */
+} dled_wire_sim_config_t;
+
+/**
+ * @brief A simulated chain of WS281x LEDs.
+ *
+ * Each LED keeps the first bits it receives and forwards the rest to the next LED.
+ * At reset all LEDs latch the received data.
+ */
+typedef struct {
+    dled_wire_sim_config_t config; /*!< Timing windows */
+    uint16_t led_count;            /*!< Number of LEDs of the chain */
+    uint32_t data_length;          /*!< Number of bytes of the chain, `led_count * bytes_per_led` */
+
+    uint8_t  *shift;               /*!< Data received since the last reset, wire order */
+    uint8_t  *latched;             /*!< Data latched at the last reset, wire order */
+    uint32_t bits;                 /*!< Number of bits received since the last reset */
+    uint64_t frame_time_ps;        /*!< Time since the last reset, in picoseconds */
+
+    uint32_t frames;               /*!< Number of resets (latches) */
+    uint64_t last_frame_time_ps;   /*!< Wire time of the last latched frame, including the reset */
+    uint32_t last_frame_bits;      /*!< Number of bits of the last latched frame */
+
+    uint32_t items;                /*!< Number of items processed */
+    uint32_t violations;           /*!< Number of timing violations */
+    uint8_t  violation_flags;      /*!< OR of all dled_sim_violation_t found */
+    int32_t  first_violation;      /*!< Index of the item with the first violation, -1 if none */
+} dled_wire_sim_t;
+
+/**
+ * @brief Set the timing windows from the datasheet of a strip's type
+ *
+ * The windows come from a table of datasheet values, independent of the strip's timings,
+ * so a wrong entry of dled_strip_set_timings or wrong custom timings are reported.
+ * The fast types are checked against the datasheet of the LEDs they overclock.
+ *
+ * @param[out] config  The timing windows.
+ * @param[in]  strip   The strip, only its type and bytes per LED are used.
+ * @param[in]  tick_ps Duration of a RMT tick, see rmt_dled_tick_ps.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `config` or `strip` argument is NULL __OR__ the strip type is DLED_NULL
+ */
+esp_err_t dled_wire_sim_config_from_datasheet(dled_wire_sim_config_t *config, const pixel_strip_t *strip,
+                                              uint32_t tick_ps);
+
+/**
+ * @brief Set the timing windows from the timings of a strip
+ *
+ * Each duration is accepted within `tolerance_ns` of its nominal value (150 ns in WS281x datasheets).
+ * The reset time is the strip's TRS.
+ * The windows follow the strip's own timings so this checks the encoding, not the timings:
+ * use dled_wire_sim_config_from_datasheet to check a stream against the LEDs.
+ *
+ * @param[out] config       The timing windows.
+ * @param[in]  strip        The strip, with the timings set by dled_strip_create.
+ * @param[in]  tick_ps      Duration of a RMT tick, see rmt_dled_tick_ps.
+ * @param[in]  tolerance_ns Accepted deviation from the nominal durations.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `config` or `strip` argument is NULL __OR__ the strip type is DLED_NULL
+ */
+esp_err_t dled_wire_sim_config_from_strip(dled_wire_sim_config_t *config, const pixel_strip_t *strip,
+                                          uint32_t tick_ps, uint16_t tolerance_ns);
+
+/**
+ * @brief Initialize a dled_wire_sim_t structure.
+ *
+ * @param[in,out] sim The structure to be initialized.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `sim` argument is NULL
+ */
+esp_err_t dled_wire_sim_init(dled_wire_sim_t *sim);
+
+/**
+ * @brief Creates the buffers of a simulated LED chain.
+ *
+ * @param[in,out] sim       The structure to work with.
+ * @param[in]     config    The timing windows.
+ * @param[in]     led_count Number of LEDs of the chain.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `sim` or `config` argument is NULL
+ *    - ESP_ERR_INVALID_SIZE if `led_count`, `bytes_per_led` or `tick_ps` is zero
+ *    - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t dled_wire_sim_create(dled_wire_sim_t *sim, const dled_wire_sim_config_t *config, uint16_t led_count);
+
+/**
+ * @brief Destroy the buffers of a simulated LED chain.
+ *
+ * Calls `dled_wire_sim_init` to initialize the structure.
+ *
+ * @param[in,out] sim The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `sim` argument is NULL
+ */
+esp_err_t dled_wire_sim_destroy(dled_wire_sim_t *sim);
+
+/**
+ * @brief Feed RMT items to the LED chain
+ *
+ * Can be called several times for one frame. An item with a zero duration is the
+ * end marker of the RMT peripheral and stops the processing.
+ *
+ * @param[in,out] sim   The structure to work with.
+ * @param[in]     items The RMT items, for example `ugly_buffer` after rmt_dled_encode.
+ * @param[in]     count Number of items.
+ *
+ * @return
+ *    - ESP_OK success, timing violations are reported in the structure
+ *    - ESP_ERR_INVALID_ARG if the `sim` or `items` argument is NULL
+ *    - ESP_ERR_INVALID_STATE if the chain is not created
+ *
+ * @code{c}
+ * dled_wire_sim_config_from_datasheet(&config, &strip, rmt_dled_tick_ps(&rps));
+ * dled_wire_sim_create(&sim, &config, strip.length);
+ * rmt_dled_encode(&rps);
+ * dled_wire_sim_feed(&sim, rps.ugly_buffer, strip.buffer_length * 8);
+ * dled_wire_sim_end(&sim);
+ * if (sim.violations != 0 || !dled_wire_sim_latched_equals(&sim, strip.buffer, strip.buffer_length)) {
+ *     ... // wrong timings or encoding
+ * }
+ * @endcode
+ */
+esp_err_t dled_wire_sim_feed(dled_wire_sim_t *sim, const rmt_item32_t *items, uint32_t count);
+
+/**
+ * @brief Signal the end of the transmission
+ *
+ * The line stays low after a transmission so the LEDs latch the data anyway, but if the last
+ * low time was shorter than reset a following transmission would be merged in the same frame
+ * so DLED_SIM_NO_RESET is reported.
+ *
+ * @param[in,out] sim The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `sim` argument is NULL
+ */
+esp_err_t dled_wire_sim_end(dled_wire_sim_t *sim);
+
+/**
+ * @brief Compare the latched data with a buffer
+ *
+ * @param[in] sim    The structure to work with.
+ * @param[in] buffer Expected data, wire order (as in `strip->buffer`).
+ * @param[in] length Length of `buffer`, must not be greater than `data_length`.
+ *
+ * @return true if the first `length` latched bytes are equal to `buffer`
+ */
+bool dled_wire_sim_latched_equals(const dled_wire_sim_t *sim, const uint8_t *buffer, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
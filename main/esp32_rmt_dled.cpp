@@ -5,6 +5,7 @@ extern "C" {
 #include "esp32_rmt_dled.h"
 
 #include <stdint.h>
+#include <stdlib.h>
 #include "esp_log.h"
 #include "driver/rmt.h"
 #include "soc/rmt_struct.h"
@@ -16,9 +17,22 @@ static const char *LOG_TAG  = "rmt_dled";
  * Standard APB clock (as needed by WiFi and BT to work) is 80 MHz.
  * This gives a 12.5 ns * rmt_config_t::clk_div for computing RMT durations, like this:
  *         duration = required_duration_in_ns / (12.5 * rmt_config_t::clk_div)
+ * The divider is chosen for each strip by rmt_dled_select_divider and durations are rounded.
  */
-const uint8_t  rmt_clk_divider  = 4;
-const uint16_t rmt_clk_duration = 50; // ns,  12.5 * 4(=config.clk_div in rmt_config_for_digital_led_strip)
+const uint32_t rmt_apb_tick_ps  = 12500;
+const uint16_t rmt_max_duration = 32767; // rmt_item32_t::duration* have 15 bits
+
+/*
+ * rmt_dled_apply_updates encodes only the changed pixels if their number
+ * is less than 1 / rmt_sparse_ratio of the strip's length.
+ */
+const uint8_t  rmt_sparse_ratio = 4;
+
+/* true if `ugly_buffer` is the encoding of the current `strip->buffer` */
+static bool rmt_dled_up_to_date(const rmt_pixel_strip_t *rps)
+{
+    return rps->encoded && rps->encoded_generation == rps->strip->generation;
+}
 
 esp_err_t rmt_dled_init(rmt_pixel_strip_t *rps)
 {
@@ -30,6 +44,14 @@ esp_err_t rmt_dled_init(rmt_pixel_strip_t *rps)
     rps->rmtLO.val = 0; rps->rmtHI.val = 0;
     rps->rmtLR.val = 0; rps->rmtHR.val = 0;
     rps->ugly_buffer = NULL;
+    rps->encoded = false;
+    rps->encoded_generation = 0;
+    rps->clk_div = 0;
+    rps->items_capacity = 0;
+    rps->configured = false;
+#ifdef CONFIG_DLED_RECORDER
+    rps->recorder = NULL;
+#endif
 
     return ESP_OK;
 }
@@ -50,6 +72,7 @@ esp_err_t rmt_dled_create(rmt_pixel_strip_t *rps, pixel_strip_t *strip)
 	}
 
     rps->strip = strip;
+    rps->encoded = false;
 
     /* for every pixel are needed `8 * rps->strip->bytes_per_led` bits
      * for every bit is needed a `rmt_item32_t` */
@@ -62,28 +85,130 @@ esp_err_t rmt_dled_create(rmt_pixel_strip_t *rps, pixel_strip_t *strip)
     else {
         ESP_LOGI(LOG_TAG, "Allocated %d bytes for ugly_buffer", req_length);
     }
+    rps->items_capacity = req_length / sizeof(rmt_item32_t);
+
+    uint32_t error_ps;
+    esp_err_t ret_val = rmt_dled_select_divider(strip, &rps->clk_div, &error_ps);
+    if (ret_val != ESP_OK) {
+        free(rps->ugly_buffer);
+        rps->ugly_buffer = NULL;
+        rps->items_capacity = 0;
+    	ESP_LOGE(LOG_TAG, "[0x%x] rmt_dled_select_divider failed", ret_val);
+    	return ret_val;
+    }
+    ESP_LOGI(LOG_TAG, "Clock divider %d, timing error %d ps", rps->clk_div, error_ps);
+
+    rmt_dled_set_items(rps);
+
+    return ESP_OK;
+}
+
+/* nearest number of ticks */
+static uint32_t rmt_dled_ticks(uint32_t ns, uint32_t tick_ps)
+{
+    return (uint32_t)(((uint64_t)ns * 1000 + tick_ps / 2) / tick_ps);
+}
+
+/* number of ticks not shorter than `ns`, used for reset */
+static uint32_t rmt_dled_ticks_ceil(uint32_t ns, uint32_t tick_ps)
+{
+    return (uint32_t)(((uint64_t)ns * 1000 + tick_ps - 1) / tick_ps);
+}
+
+static uint32_t rmt_dled_tick_error(uint32_t ns, uint32_t ticks, uint32_t tick_ps)
+{
+    int64_t err = (int64_t)ticks * tick_ps - (int64_t)ns * 1000;
+    return (uint32_t)(err < 0 ? -err : err);
+}
+
+esp_err_t rmt_dled_select_divider(const pixel_strip_t *strip, uint8_t *clk_div, uint32_t *error_ps)
+{
+	if (strip == NULL || clk_div == NULL) {
+		ESP_LOGE(LOG_TAG, "argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    const uint32_t durations[4] = { strip->T0H, strip->T0L, strip->T1H, strip->T1L };
+    uint32_t best_error = UINT32_MAX;
+    uint8_t  best_div = 0;
+
+    for (uint16_t div = 1; div <= 255; div++) {
+        uint32_t tick_ps = rmt_apb_tick_ps * div;
+        if (rmt_dled_ticks_ceil(strip->TRS, tick_ps) > rmt_max_duration) continue;
+
+        uint32_t error = 0;
+        bool valid = true;
+        for (uint8_t i = 0; i < 4; i++) {
+            uint32_t ticks = rmt_dled_ticks(durations[i], tick_ps);
+            if (ticks == 0 || ticks > rmt_max_duration) { valid = false; break; }
+            error += rmt_dled_tick_error(durations[i], ticks, tick_ps);
+        }
+
+        /* on equal errors the smaller divider is kept */
+        if (valid && error < best_error) {
+            best_error = error;
+            best_div = (uint8_t)div;
+        }
+    }
+
+    if (best_div == 0) {
+		ESP_LOGE(LOG_TAG, "No clock divider fits the timings");
+		return ESP_ERR_INVALID_ARG;
+    }
+
+    *clk_div = best_div;
+    if (error_ps != NULL) { *error_ps = best_error; }
+
+    return ESP_OK;
+}
+
+void rmt_dled_set_items(rmt_pixel_strip_t *rps)
+{
+    pixel_strip_t *strip = rps->strip;
+    uint32_t tick_ps = rmt_dled_tick_ps(rps);
 
 	rps->rmtLO.level0 = 1;
 	rps->rmtLO.level1 = 0;
-	rps->rmtLO.duration0 = strip->T0H / rmt_clk_duration;
-	rps->rmtLO.duration1 = strip->T0L / rmt_clk_duration;
+	rps->rmtLO.duration0 = rmt_dled_ticks(strip->T0H, tick_ps);
+	rps->rmtLO.duration1 = rmt_dled_ticks(strip->T0L, tick_ps);
 
 	rps->rmtHI.level0 = 1;
 	rps->rmtHI.level1 = 0;
-	rps->rmtHI.duration0 = strip->T1H / rmt_clk_duration;
-	rps->rmtHI.duration1 = strip->T1L / rmt_clk_duration;
+	rps->rmtHI.duration0 = rmt_dled_ticks(strip->T1H, tick_ps);
+	rps->rmtHI.duration1 = rmt_dled_ticks(strip->T1L, tick_ps);
 
 	rps->rmtLR.level0 = 1;
 	rps->rmtLR.level1 = 0;
-	rps->rmtLR.duration0 = strip->T0H / rmt_clk_duration;
-	rps->rmtLR.duration1 = strip->TRS / rmt_clk_duration;
+	rps->rmtLR.duration0 = rmt_dled_ticks(strip->T0H, tick_ps);
+	rps->rmtLR.duration1 = rmt_dled_ticks_ceil(strip->TRS, tick_ps);
 
 	rps->rmtHR.level0 = 1;
 	rps->rmtHR.level1 = 0;
-	rps->rmtHR.duration0 = strip->T1H / rmt_clk_duration;
-	rps->rmtHR.duration1 = strip->TRS / rmt_clk_duration;
+	rps->rmtHR.duration0 = rmt_dled_ticks(strip->T1H, tick_ps);
+	rps->rmtHR.duration1 = rmt_dled_ticks_ceil(strip->TRS, tick_ps);
+}
 
-    return ESP_OK;
+uint32_t rmt_dled_frame_time_ns(const rmt_pixel_strip_t *rps)
+{
+    if (rps == NULL || rps->strip == NULL) return 0;
+
+    uint32_t bits = (uint32_t)rps->strip->buffer_length * 8;
+    if (bits == 0) return 0;
+
+    uint32_t bit_lo = rps->rmtLO.duration0 + rps->rmtLO.duration1;
+    uint32_t bit_hi = rps->rmtHI.duration0 + rps->rmtHI.duration1;
+    uint32_t bit_max = (bit_lo > bit_hi) ? bit_lo : bit_hi;
+    uint32_t last_max = (rps->rmtLR.duration0 > rps->rmtHR.duration0) ? rps->rmtLR.duration0 : rps->rmtHR.duration0;
+    last_max += rps->rmtLR.duration1;
+
+    uint64_t ticks = (uint64_t)(bits - 1) * bit_max + last_max;
+    return (uint32_t)(ticks * rmt_dled_tick_ps(rps) / 1000);
+}
+
+uint32_t rmt_dled_tick_ps(const rmt_pixel_strip_t *rps)
+{
+    if (rps == NULL) return 0;
+    return rmt_apb_tick_ps * rps->clk_div;
 }
 
 void rmt_dled_set_gpio(rmt_pixel_strip_t *rps)
@@ -100,6 +225,50 @@ esp_err_t rmt_dled_config(rmt_pixel_strip_t *rps, gpio_num_t gpio_number_in, rmt
 		return ESP_ERR_INVALID_ARG;
 	}
 
+    esp_err_t ret_val;
+
+    if (rps->configured) {
+        if (rps->channel == channel_in) {
+            /* the driver is installed, only update what may have changed */
+            if (rps->gpio_number != gpio_number_in) {
+                /* the GPIO matrix keeps the old pin connected to the channel, detach it first */
+                ret_val = gpio_reset_pin(rps->gpio_number);
+                if(ret_val != ESP_OK) {
+                    ESP_LOGE(LOG_TAG, "[0x%x] gpio_reset_pin failed", ret_val);
+                    return ret_val;
+                }
+                rps->gpio_number = gpio_number_in;
+                rmt_dled_set_gpio(rps);
+                ret_val = rmt_set_pin(rps->channel, rmt_mode_t::RMT_MODE_TX, rps->gpio_number);
+                if(ret_val != ESP_OK) {
+                    ESP_LOGE(LOG_TAG, "[0x%x] rmt_set_pin failed", ret_val);
+                    return ret_val;
+                }
+            }
+            ret_val = rmt_set_clk_div(rps->channel, rps->clk_div);
+            if(ret_val != ESP_OK) {
+                ESP_LOGE(LOG_TAG, "[0x%x] rmt_set_clk_div failed", ret_val);
+                return ret_val;
+            }
+            return ESP_OK;
+        }
+
+        ret_val = rmt_driver_uninstall(rps->channel);
+        if(ret_val != ESP_OK) {
+            ESP_LOGE(LOG_TAG, "[0x%x] rmt_driver_uninstall failed", ret_val);
+            return ret_val;
+        }
+        rps->configured = false;
+
+        if (rps->gpio_number != gpio_number_in) {
+            ret_val = gpio_reset_pin(rps->gpio_number);
+            if(ret_val != ESP_OK) {
+                ESP_LOGE(LOG_TAG, "[0x%x] gpio_reset_pin failed", ret_val);
+                return ret_val;
+            }
+        }
+    }
+
     rps->gpio_number = gpio_number_in;
     rps->channel = channel_in;
 
@@ -109,7 +278,7 @@ esp_err_t rmt_dled_config(rmt_pixel_strip_t *rps, gpio_num_t gpio_number_in, rmt
 
     config.rmt_mode = rmt_mode_t::RMT_MODE_TX;
     config.channel  = rps->channel;
-    config.clk_div  = rmt_clk_divider;
+    config.clk_div  = rps->clk_div;
     config.gpio_num = rps->gpio_number;
 
     /* One memory block is 64 words * 32 bits each; the type is rmt_item32_t (defined in rmt_struct.h).
@@ -126,8 +295,6 @@ esp_err_t rmt_dled_config(rmt_pixel_strip_t *rps, gpio_num_t gpio_number_in, rmt
     config.tx_config.idle_output_en       = true;
 
     // stop this rmt channel
-    esp_err_t ret_val;
-
 	ret_val = rmt_rx_stop(rps->channel);
     if(ret_val != ESP_OK) {
     	ESP_LOGE(LOG_TAG, "[0x%x] rmt_rx_stop failed", ret_val);
@@ -167,14 +334,15 @@ esp_err_t rmt_dled_config(rmt_pixel_strip_t *rps, gpio_num_t gpio_number_in, rmt
     	ESP_LOGE(LOG_TAG, "[0x%x] rmt_driver_install failed", ret_val);
     	return ret_val;
     }
+    rps->configured = true;
 
     return ESP_OK;
 }
 
-void rmt_dled_byte_to_rmtitem(rmt_pixel_strip_t *rps, uint8_t data, uint16_t idx_in)
+void rmt_dled_byte_to_rmtitem(rmt_pixel_strip_t *rps, uint8_t data, uint32_t idx_in)
 {
 	uint8_t mask = 0x80;
-	uint16_t idx = idx_in;
+	uint32_t idx = idx_in;
 
 	while (mask != 0){
 		rps->ugly_buffer[idx++] =
@@ -183,7 +351,7 @@ void rmt_dled_byte_to_rmtitem(rmt_pixel_strip_t *rps, uint8_t data, uint16_t idx
 	}
 }
 
-esp_err_t rmt_dled_send(rmt_pixel_strip_t *rps)
+esp_err_t rmt_dled_encode(rmt_pixel_strip_t *rps)
 {
 	if (rps == NULL) {
 		ESP_LOGE(LOG_TAG, "argument is NULL");
@@ -206,22 +374,92 @@ esp_err_t rmt_dled_send(rmt_pixel_strip_t *rps)
 		return ESP_ERR_INVALID_ARG;
 	}
 
-	uint16_t didx = 0;
-	for (uint16_t i = 0; i < rps->strip->buffer_length; i++) {
+	rmt_dled_encode_range(rps, 0, rps->strip->buffer_length);
+	rmt_dled_encode_reset(rps);
+
+    return ESP_OK;
+}
+
+void rmt_dled_encode_range(rmt_pixel_strip_t *rps, uint16_t first, uint16_t count)
+{
+	uint32_t didx = (uint32_t)first * 8;
+	for (uint32_t i = first; i < (uint32_t)first + count; i++) {
 		rmt_dled_byte_to_rmtitem(rps, rps->strip->buffer[i], didx);
 		didx += 8;
 	}
+}
 
-	// change last bit to include reset time
-	didx--;
-	if (rps->ugly_buffer[didx].val == rps->rmtHI.val) {
+void rmt_dled_encode_reset(rmt_pixel_strip_t *rps)
+{
+	// change last bit to include reset time, the last item may already include it
+	uint32_t didx = (uint32_t)rps->strip->buffer_length * 8 - 1;
+	uint32_t val = rps->ugly_buffer[didx].val;
+	if (val == rps->rmtHI.val || val == rps->rmtHR.val) {
 		rps->ugly_buffer[didx] = rps->rmtHR;
 	}
 	else {
 		rps->ugly_buffer[didx] = rps->rmtLR;
 	}
 
-	esp_err_t ret_val = rmt_write_items(rps->channel, rps->ugly_buffer, rps->strip->buffer_length * 8, true);
+	rps->encoded = true;
+	rps->encoded_generation = rps->strip->generation;
+}
+
+esp_err_t rmt_dled_apply_updates(rmt_pixel_strip_t *rps, const pixel_update_t *updates, uint16_t count)
+{
+	if (rps == NULL || updates == NULL) {
+		ESP_LOGE(LOG_TAG, "argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rps->strip == NULL || rps->ugly_buffer == NULL) {
+		ESP_LOGE(LOG_TAG, "buffer is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	/* checked before dled_strip_apply_updates, which changes the generation */
+	bool up_to_date = rmt_dled_up_to_date(rps);
+
+	esp_err_t ret_val = dled_strip_apply_updates(rps->strip, updates, count);
+	if (ret_val != ESP_OK) return ret_val;
+
+	/* a partial update encodes 8 * bytes_per_led items per change, a full one 8 * buffer_length */
+	if (!up_to_date || (uint32_t)count * rmt_sparse_ratio >= rps->strip->length) {
+		return rmt_dled_encode(rps);
+	}
+
+	uint8_t bpl = rps->strip->bytes_per_led;
+	bool last_changed = false;
+	for (uint16_t i = 0; i < count; i++) {
+		rmt_dled_encode_range(rps, updates[i].index * bpl, bpl);
+		if (updates[i].index == rps->strip->length - 1) last_changed = true;
+	}
+	if (last_changed) rmt_dled_encode_reset(rps);
+	rps->encoded_generation = rps->strip->generation;
+
+	return ESP_OK;
+}
+
+esp_err_t rmt_dled_write(rmt_pixel_strip_t *rps, bool wait_tx_done)
+{
+	if (rps == NULL) {
+		ESP_LOGE(LOG_TAG, "argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rps->ugly_buffer == NULL) {
+		ESP_LOGE(LOG_TAG, "ugly buffer is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rps->strip == NULL) {
+		ESP_LOGE(LOG_TAG, "buffer is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+#ifdef CONFIG_DLED_RECORDER
+    if (rps->recorder != NULL)
+        dled_recorder_capture(rps->recorder, rps->strip->buffer, rps->strip->buffer_length);
+#endif
+
+	esp_err_t ret_val = rmt_write_items(rps->channel, rps->ugly_buffer, rps->strip->buffer_length * 8, wait_tx_done);
     if(ret_val != ESP_OK) {
     	ESP_LOGE(LOG_TAG, "[0x%x] rmt_write_items failed", ret_val);
     	return ret_val;
@@ -230,6 +468,113 @@ esp_err_t rmt_dled_send(rmt_pixel_strip_t *rps)
     return ESP_OK;
 }
 
+esp_err_t rmt_dled_wait_tx_done(rmt_pixel_strip_t *rps)
+{
+	if (rps == NULL) {
+		ESP_LOGE(LOG_TAG, "argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	esp_err_t ret_val = rmt_wait_tx_done(rps->channel, portMAX_DELAY);
+    if(ret_val != ESP_OK) {
+    	ESP_LOGE(LOG_TAG, "[0x%x] rmt_wait_tx_done failed", ret_val);
+    	return ret_val;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t rmt_dled_send(rmt_pixel_strip_t *rps)
+{
+	esp_err_t ret_val = rmt_dled_encode(rps);
+	if (ret_val != ESP_OK) return ret_val;
+
+	return rmt_dled_write(rps, true);
+}
+
+esp_err_t rmt_dled_resize(rmt_pixel_strip_t *rps, uint16_t length)
+{
+	if (rps == NULL) {
+		ESP_LOGE(LOG_TAG, "argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rps->strip == NULL || rps->ugly_buffer == NULL) {
+		ESP_LOGE(LOG_TAG, "not created");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    pixel_strip_t *strip = rps->strip;
+    uint16_t old_bytes = strip->buffer_length;
+
+    if (length == strip->length) return ESP_OK;
+
+    /* grow the items first so a failure leaves both unchanged */
+    uint32_t req_items = (uint32_t)length * 8 * strip->bytes_per_led;
+    if (req_items > rps->items_capacity) {
+        rmt_item32_t *items = (rmt_item32_t*)realloc(rps->ugly_buffer, req_items * sizeof(rmt_item32_t));
+        if (items == NULL) {
+            ESP_LOGE(LOG_TAG, "Failed to reallocate memory for ugly buffer");
+            return ESP_ERR_NO_MEM;
+        }
+        rps->ugly_buffer = items;
+        rps->items_capacity = req_items;
+    }
+
+    bool up_to_date = rmt_dled_up_to_date(rps);
+
+    esp_err_t ret_val = dled_strip_resize(strip, length);
+    if (ret_val != ESP_OK) return ret_val;
+
+    if (!up_to_date) return ESP_OK;
+
+    /* only the items of the new pixels and the old or new last item change */
+    if (strip->buffer_length > old_bytes) {
+        rmt_dled_encode_range(rps, old_bytes - 1, strip->buffer_length - old_bytes + 1);
+    }
+    rmt_dled_encode_reset(rps);
+
+    return ESP_OK;
+}
+
+esp_err_t rmt_dled_set_type(rmt_pixel_strip_t *rps, dstrip_type_t strip_type)
+{
+	if (rps == NULL) {
+		ESP_LOGE(LOG_TAG, "argument is NULL");
+		return ESP_ERR_INVALID_ARG;
+	}
+	if (rps->strip == NULL) {
+		ESP_LOGE(LOG_TAG, "not created");
+		return ESP_ERR_INVALID_ARG;
+	}
+
+    uint8_t clk_div;
+    pixel_strip_t old_strip = *rps->strip;
+
+    esp_err_t ret_val = dled_strip_set_type(rps->strip, strip_type);
+    if (ret_val != ESP_OK) return ret_val;
+
+    ret_val = rmt_dled_select_divider(rps->strip, &clk_div, NULL);
+    if (ret_val != ESP_OK) {
+        *rps->strip = old_strip;
+        return ret_val;
+    }
+
+    if (rps->configured && clk_div != rps->clk_div) {
+        ret_val = rmt_set_clk_div(rps->channel, clk_div);
+        if(ret_val != ESP_OK) {
+            *rps->strip = old_strip;
+            ESP_LOGE(LOG_TAG, "[0x%x] rmt_set_clk_div failed", ret_val);
+            return ret_val;
+        }
+    }
+    rps->clk_div = clk_div;
+
+    rmt_dled_set_items(rps);
+    rps->encoded = false;
+
+    return ESP_OK;
+}
+
 #ifdef __cplusplus
 }
 #endif
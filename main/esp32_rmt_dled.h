@@ -5,11 +5,19 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "driver/rmt.h"
 #include "soc/rmt_struct.h"
 
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
 #include "dled_strip.h"
+#ifdef CONFIG_DLED_RECORDER
+#include "dled_recorder.h"
+#endif
 
 /**
  * @brief Structure to control a LED strip using the RMT peripheral
@@ -24,6 +32,14 @@ typedef struct {
     rmt_item32_t  rmtLR, rmtHR; /*!< Values required to send 0 and 1 including reset */
 
 	rmt_item32_t  *ugly_buffer; /*!< The buffer to be passed to the RMT driver for sending */
+	bool          encoded;      /*!< true if `ugly_buffer` holds the encoding of `strip->buffer` as of `encoded_generation` */
+	uint32_t      encoded_generation; /*!< `strip->generation` when `ugly_buffer` was encoded */
+	uint8_t       clk_div;      /*!< The RMT clock divider, set by rmt_dled_create */
+	uint32_t      items_capacity; /*!< Number of items allocated for `ugly_buffer` */
+	bool          configured;   /*!< true after the RMT driver was installed by rmt_dled_config */
+#ifdef CONFIG_DLED_RECORDER
+	dled_recorder_t *recorder;  /*!< If not NULL every frame written by rmt_dled_write is captured */
+#endif
 } rmt_pixel_strip_t;
 
 /**
@@ -41,7 +57,8 @@ esp_err_t rmt_dled_init(rmt_pixel_strip_t *rps);
  * @brief Creates the buffer and set the `rmt_item32_t` members of a rmt_pixel_strip_t structure.
  *
  * Creates the buffer to be passed to the RMT driver for sending.
- * Based on `strip` sets rmtLO, rmtHI, rmtLR and rmtHR members.
+ * Based on `strip` timings selects the clock divider with rmt_dled_select_divider
+ * and sets rmtLO, rmtHI, rmtLR and rmtHR members.
  *
  * @param[in,out] rps   The structure to work with.
  * @param[in]     strip The strip of pixels.
@@ -51,9 +68,57 @@ esp_err_t rmt_dled_init(rmt_pixel_strip_t *rps);
  *    - ESP_ERR_INVALID_ARG if the `rps` or `strip` arguments are NULL
  *    - ESP_ERR_INVALID_SIZE if `strip->length` is zero
  *    - ESP_ERR_NO_MEM if failed to allocate memory for buffer
+ *    - the error codes of rmt_dled_select_divider
  */
 esp_err_t rmt_dled_create(rmt_pixel_strip_t *rps, pixel_strip_t *strip);
 
+/**
+ * @brief Select the RMT clock divider for the timings of a strip
+ *
+ * Durations are rounded to the nearest number of RMT ticks (the reset is rounded up).
+ * The divider giving the smallest total error of T0H, T0L, T1H and T1L is selected,
+ * as long as all durations, including the reset, fit in a `rmt_item32_t`.
+ *
+ * @param[in]  strip    The strip, with the timings set.
+ * @param[out] clk_div  The selected clock divider.
+ * @param[out] error_ps Sum of the absolute errors of the four bit durations, in picoseconds, may be NULL.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `strip` or `clk_div` argument is NULL __OR__ no divider fits the timings
+ */
+esp_err_t rmt_dled_select_divider(const pixel_strip_t *strip, uint8_t *clk_div, uint32_t *error_ps);
+
+/**
+ * @brief Set the rmtLO, rmtHI, rmtLR and rmtHR members
+ *
+ * Computes the `rmt_item32_t` values from the strip's timings and `clk_div`.
+ *
+ * @param[in,out] rps The structure to work with, `strip` must not be NULL.
+ */
+void rmt_dled_set_items(rmt_pixel_strip_t *rps);
+
+/**
+ * @brief Get the wire time of a frame
+ *
+ * This is the time needed to send the whole strip, including the reset, when all
+ * bits have the longest duration. The maximum frame rate is 1e9 / this value.
+ *
+ * @param[in] rps The structure to work with.
+ *
+ * @return The wire time in nanoseconds or zero if `rps` or `rps->strip` is NULL.
+ */
+uint32_t rmt_dled_frame_time_ns(const rmt_pixel_strip_t *rps);
+
+/**
+ * @brief Get the duration of a RMT tick
+ *
+ * @param[in] rps The structure, rmt_dled_create must be called first.
+ *
+ * @return The duration of a tick in picoseconds or zero if `rps` is NULL or not created.
+ */
+uint32_t rmt_dled_tick_ps(const rmt_pixel_strip_t *rps);
+
 /**
  * @brief Configures the RMT peripheral
  *
@@ -61,6 +126,11 @@ esp_err_t rmt_dled_create(rmt_pixel_strip_t *rps, pixel_strip_t *strip);
  * Configure the RMT peripheral using the RMT driver.
  * Sets `gpio_number` and `channel` members.
  *
+ * If the structure is already configured on the same channel the driver is not installed
+ * again, only the GPIO and the clock divider are updated. On another channel the driver
+ * of the old channel is uninstalled first. A previous GPIO is reset with gpio_reset_pin so
+ * it does not output the channel any more.
+ *
  * @param[in,out] rps         The structure to work with.
  * @param[in]     gpio_number The number of GPIO connected to the LED strip.
  * @param[in]     channel     The RMT channel to control the LED strip.
@@ -68,7 +138,7 @@ esp_err_t rmt_dled_create(rmt_pixel_strip_t *rps, pixel_strip_t *strip);
  * @return
  *    - ESP_OK success
  *    - ESP_ERR_INVALID_ARG if the `rps` argument is NULL
- *    - the error codes returned by the RMT driver, if error
+ *    - the error codes returned by the RMT and GPIO drivers, if error
  */
 esp_err_t rmt_dled_config(rmt_pixel_strip_t *rps, gpio_num_t gpio_number, rmt_channel_t channel);
 
@@ -89,6 +159,148 @@ esp_err_t rmt_dled_config(rmt_pixel_strip_t *rps, gpio_num_t gpio_number, rmt_ch
  */
 esp_err_t rmt_dled_send(rmt_pixel_strip_t *rps);
 
+/**
+ * @brief Convert the strip's output buffer to RMT items
+ *
+ * Fills `ugly_buffer` from `strip->buffer`. This is the first half of rmt_dled_send.
+ * The pipeline uses it to encode the next frame while the previous one is transmitted.
+ *
+ * @param[in,out] rps The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rps` argument is NULL
+ *    - ESP_ERR_INVALID_ARG if `rps->strip` or a buffer is NULL
+ *    - ESP_ERR_INVALID_ARG if the strip's output buffer length is zero
+ */
+esp_err_t rmt_dled_encode(rmt_pixel_strip_t *rps);
+
+/**
+ * @brief Convert a part of the strip's output buffer to RMT items
+ *
+ * Ranges do not overlap in `ugly_buffer` so they can be encoded in parallel.
+ * After all ranges are encoded call rmt_dled_encode_reset.
+ *
+ * @attention: For speed, the arguments are not checked. `first + count` must not be
+ * greater than `strip->buffer_length` !
+ *
+ * @param[in,out] rps   The structure to work with.
+ * @param[in]     first First byte of `strip->buffer` to encode.
+ * @param[in]     count Number of bytes to encode.
+ */
+void rmt_dled_encode_range(rmt_pixel_strip_t *rps, uint16_t first, uint16_t count);
+
+/**
+ * @brief Change the last RMT item to include the reset time
+ *
+ * Must be called after the last byte of `strip->buffer` was encoded by rmt_dled_encode_range.
+ * Calling it again does not change the items.
+ *
+ * @param[in,out] rps The structure to work with.
+ */
+void rmt_dled_encode_reset(rmt_pixel_strip_t *rps);
+
+/**
+ * @brief Send the RMT items to RMT driver
+ *
+ * This is the second half of rmt_dled_send.
+ * With CONFIG_DLED_RECORDER enabled and `recorder` set, `strip->buffer` is captured before sending.
+ *
+ * @attention: If `wait_tx_done` is false `ugly_buffer` is used by the RMT driver until the
+ * transmission ends so it must not be changed before rmt_dled_wait_tx_done returns !
+ *
+ * @param[in] rps          The structure to work with.
+ * @param[in] wait_tx_done Wait for the transmission to end before returning.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rps` argument is NULL
+ *    - ESP_ERR_INVALID_ARG if `rps->strip` or `ugly_buffer` is NULL
+ *    - the error codes returned by the RMT driver, if error
+ */
+esp_err_t rmt_dled_write(rmt_pixel_strip_t *rps, bool wait_tx_done);
+
+/**
+ * @brief Wait for the transmission started by rmt_dled_write to end
+ *
+ * @param[in] rps The structure to work with.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rps` argument is NULL
+ *    - the error codes returned by the RMT driver, if error
+ */
+esp_err_t rmt_dled_wait_tx_done(rmt_pixel_strip_t *rps);
+
+/**
+ * @brief Apply a batch of pixel changes and update the RMT items
+ *
+ * For a few changes only the changed pixels are written in `strip->pixels`, `strip->buffer`
+ * and `ugly_buffer`. For many changes, or if `ugly_buffer` is not up to date, the whole
+ * buffer is encoded again. The result is the same as changing `strip->pixels` then calling
+ * dled_strip_fill_buffer and rmt_dled_encode.
+ * `ugly_buffer` is up to date if `strip->generation` did not change since the last encoding,
+ * so any other write of `strip->buffer` (dled_strip_fill_buffer, dled_dmx_parse, ...) makes
+ * this function encode the whole buffer.
+ *
+ * @attention: Do not call it while a transmission started by rmt_dled_write(rps, false) is not done !
+ *
+ * @param[in,out] rps     The structure to work with.
+ * @param[in]     updates The changes, applied in order.
+ * @param[in]     count   Number of changes.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rps` or `updates` argument is NULL
+ *    - the error codes of dled_strip_apply_updates and rmt_dled_encode
+ *
+ * @code{c}
+ * pixel_update_t updates[2] = { { 3, { 32, 0, 0 } }, { 17, { 0, 0, 0 } } };
+ * if (rmt_dled_apply_updates(&rps, updates, 2) == ESP_OK)
+ *     rmt_dled_write(&rps, true);
+ * @endcode
+ */
+esp_err_t rmt_dled_apply_updates(rmt_pixel_strip_t *rps, const pixel_update_t *updates, uint16_t count);
+
+/**
+ * @brief Change the number of LEDs without reconfiguring the RMT channel
+ *
+ * Calls dled_strip_resize for the strip and reallocates `ugly_buffer` only when it grows.
+ * If `ugly_buffer` is up to date only the items of the new pixels and the last item are
+ * encoded, the new pixels being off. The RMT driver stays installed.
+ * Does nothing if `length` is the current number of LEDs.
+ *
+ * @attention: Stop and destroy a pipeline using this strip before resizing !
+ *
+ * @param[in,out] rps    The structure to work with.
+ * @param[in]     length The new number of digital LEDs.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rps` argument is NULL or not created
+ *    - ESP_ERR_NO_MEM if failed to reallocate memory
+ *    - the error codes of dled_strip_resize
+ */
+esp_err_t rmt_dled_resize(rmt_pixel_strip_t *rps, uint16_t length);
+
+/**
+ * @brief Change the type of digital LEDs without reconfiguring the RMT channel
+ *
+ * Sets the strip's type and timings, selects the clock divider and sets it on the
+ * channel if configured, then recomputes rmtLO, rmtHI, rmtLR and rmtHR.
+ * All items change so `encoded` is cleared and the next rmt_dled_encode does the work.
+ *
+ * @param[in,out] rps        The structure to work with.
+ * @param[in]     strip_type The type of digital LEDs.
+ *
+ * @return
+ *    - ESP_OK success
+ *    - ESP_ERR_INVALID_ARG if the `rps` argument is NULL or not created
+ *    - the error codes of dled_strip_set_type and rmt_dled_select_divider
+ *    - the error codes returned by the RMT driver, if error
+ */
+esp_err_t rmt_dled_set_type(rmt_pixel_strip_t *rps, dstrip_type_t strip_type);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@
 #include "esp_log.h"
 
 #include "esp32_rmt_dled.h"
+#include "dled_pipeline.h"
 
 static const char *TAG = "main";
 
@@ -14,11 +15,17 @@ void delay_ms(uint32_t ms)
     vTaskDelay(ms / portTICK_PERIOD_MS);
 }
 
+void render_rainbow(pixel_t *pixels, uint16_t length, uint8_t max_cc_val, uint32_t frame, void *arg)
+{
+    dled_pixel_rainbow_step(pixels, length, max_cc_val, (uint16_t)frame);
+}
+
 void app_main(void)
 {
     esp_err_t err;
-    rmt_pixel_strip_t rps;
-    pixel_strip_t strip;
+    /* static because the pipeline tasks use them after app_main returns */
+    static rmt_pixel_strip_t rps;
+    static pixel_strip_t strip;
 
     nvs_flash_init();
 
@@ -54,13 +61,26 @@ void app_main(void)
         delay_ms(20);
     }
 
-    step = 0;
-    while (true) {
-        dled_pixel_rainbow_step(strip.pixels, strip.length, strip.max_cc_val, step);
-        dled_strip_fill_buffer(&strip);
-        rmt_dled_send(&rps);
-        step++;
-        delay_ms(50);
+    /* render on core 1, fill, encode and send on core 0 */
+    static dled_pipeline_t pipeline;
+    dled_pipeline_init(&pipeline);
+    err = dled_pipeline_create(&pipeline, &rps, render_rainbow, NULL, 2, DLED_FQ_BLOCK);
+    if (err == ESP_OK) {
+        pipeline.frame_period_ms = 50;
+        err = dled_pipeline_start(&pipeline, 1, 0, 5);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "[0x%x] dled_pipeline_start failed", err);
+        /* frees the queue and the second item buffer, rps keeps its own */
+        dled_pipeline_destroy(&pipeline);
+        step = 0;
+        while (true) {
+            dled_pixel_rainbow_step(strip.pixels, strip.length, strip.max_cc_val, step);
+            dled_strip_fill_buffer(&strip);
+            rmt_dled_send(&rps);
+            step++;
+            delay_ms(50);
+        }
     }
 
     vTaskDelete(NULL);